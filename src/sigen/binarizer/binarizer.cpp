@@ -1,28 +1,123 @@
 #include "sigen/binarizer/binarizer.h"
+#include "sigen/common/parallel.h"
+#include "sigen/common/threshold.h"
+#include <algorithm>
 #include <cstdint>
 #include <glog/logging.h>
-#include <opencv2/imgproc/imgproc.hpp>
+#include <vector>
 namespace sigen {
-BinaryCube Binarizer::Binarize(const ImageSequence &is, const int thresh) {
+static void checkImage(const cv::Mat &image, const int width, const int height) {
+  CHECK_EQ(2, image.dims);
+  CHECK_EQ(1, image.channels());
+  CHECK(image.depth() == CV_8U || image.depth() == CV_16U || image.depth() == CV_32F)
+      << "unsupported depth: " << image.depth();
+  CHECK_EQ(width, image.cols);
+  CHECK_EQ(height, image.rows);
+}
+
+// same as cv::THRESH_BINARY: foreground if val > thresh
+static void packRow(const cv::Mat &image, const int y, const double thresh, uint64_t *dst) {
+  switch (image.depth()) {
+  case CV_8U:
+    PackGreater(image.ptr<uint8_t>(y), image.cols, thresh, dst);
+    break;
+  case CV_16U:
+    PackGreater(image.ptr<uint16_t>(y), image.cols, thresh, dst);
+    break;
+  case CV_32F:
+    PackGreater(image.ptr<float>(y), image.cols, thresh, dst);
+    break;
+  default:
+    LOG(FATAL) << "unsupported depth: " << image.depth();
+  }
+}
+
+BinaryCube Binarizer::Binarize(const ImageSequence &is, const double thresh) {
   CHECK(!is.empty());
-  int width = is[0].cols;
-  int height = is[0].rows;
-  BinaryCube cube(width, height, is.size());
+  BinaryCube cube(is[0].cols, is[0].rows, is.size());
+  Binarize(is, thresh, cube);
+  return cube;
+}
+
+// slices write disjoint rows, so they are binarized in parallel
+void Binarizer::Binarize(const ImageSequence &is, const double thresh, BinaryCube &cube) {
+  CHECK_EQ(cube.z_, (int)is.size());
+#pragma omp parallel for schedule(dynamic)
   for (int z = 0; z < (int)is.size(); ++z) {
-    const cv::Mat &image = is[z];
-    CHECK_EQ(2, image.dims);
-    CHECK_EQ(1, image.channels());
-    CHECK_EQ(width, image.cols);
-    CHECK_EQ(height, image.rows);
-    cv::Mat bin;
-    // newval = maxval if val > thresh else 0
-    cv::threshold(image, bin, thresh, /* maxval = */ 255,
-                  cv::THRESH_BINARY);
-    for (int x = 0; x < width; ++x) {
-      for (int y = 0; y < height; ++y) {
-        cube[x][y][z] = bin.at<uint8_t>(y, x);
+    BinarizeSlice(is[z], z, thresh, cube);
+  }
+}
+
+void Binarizer::BinarizeSlice(const cv::Mat &image, const int z, const double thresh, BinaryCube &cube) {
+  checkImage(image, cube.x_, cube.y_);
+  for (int y = 0; y < cube.y_; ++y) {
+    packRow(image, y, thresh, cube.Row(y, z));
+  }
+}
+
+void Binarizer::BinarizeSlice(const cv::Mat &image, const int z, const double thresh, BrickedCube &cube) {
+  checkImage(image, cube.x_, cube.y_);
+  std::vector<uint64_t> row((cube.x_ + 63) / 64);
+  std::vector<uint64_t> layers(cube.BricksX());
+  for (int by = 0; by < cube.BricksY(); ++by) {
+    std::fill(layers.begin(), layers.end(), 0);
+    for (int y = by * 8; y < std::min(cube.y_, by * 8 + 8); ++y) {
+      packRow(image, y, thresh, &row[0]);
+      for (int bx = 0; bx < cube.BricksX(); ++bx) {
+        const uint64_t byte = (row[bx >> 3] >> ((bx & 7) * 8)) & 0xff;
+        layers[bx] |= byte << ((y & 7) * 8);
       }
     }
+    for (int bx = 0; bx < cube.BricksX(); ++bx) {
+      cube.SetLayer(cube.BrickIndex(bx, by, z >> 3), z & 7, layers[bx]);
+    }
+  }
+}
+
+void Binarizer::BinarizeSlice(const cv::Mat &image, const int z, const double thresh, RunLengthCube &cube) {
+  checkImage(image, cube.x_, cube.y_);
+  std::vector<uint64_t> row((cube.x_ + 63) / 64);
+  for (int y = 0; y < cube.y_; ++y) {
+    packRow(image, y, thresh, &row[0]);
+    cube.AppendRow(y, z, &row[0]);
+  }
+}
+
+// Slices of a brick layer share the population counts of their bricks,
+// so brick layers (8 slices each) are binarized in parallel.
+BrickedCube Binarizer::BinarizeBricked(const ImageSequence &is, const double thresh) {
+  CHECK(!is.empty());
+  BrickedCube cube(is[0].cols, is[0].rows, is.size());
+#pragma omp parallel for schedule(dynamic)
+  for (int bz = 0; bz < cube.BricksZ(); ++bz) {
+    for (int z = bz * 8; z < std::min(cube.z_, bz * 8 + 8); ++z) {
+      BinarizeSlice(is[z], z, thresh, cube);
+    }
+  }
+  return cube;
+}
+
+// Runs have to be appended in raster order, so a chunk of slices is
+// encoded in parallel and then appended in order.
+RunLengthCube Binarizer::BinarizeRunLength(const ImageSequence &is, const double thresh) {
+  CHECK(!is.empty());
+  int width = is[0].cols;
+  int height = is[0].rows;
+  RunLengthCube cube(width, height, is.size());
+  const int chunk = 4 * GetNumThreads();
+  for (int z0 = 0; z0 < (int)is.size(); z0 += chunk) {
+    const int z1 = std::min((int)is.size(), z0 + chunk);
+    std::vector<RunLengthCube> slices(z1 - z0);
+#pragma omp parallel for schedule(dynamic)
+    for (int z = z0; z < z1; ++z) {
+      RunLengthCube slice(width, height, 1);
+      BinarizeSlice(is[z], 0, thresh, slice);
+      slices[z - z0].Swap(slice);
+    }
+    for (int z = z0; z < z1; ++z) {
+      cube.AppendSlice(z, slices[z - z0]);
+      slices[z - z0].Clear();
+    }
   }
   return cube;
 }
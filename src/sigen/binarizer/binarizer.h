@@ -1,9 +1,24 @@
 #pragma once
 #include "sigen/common/binary_cube.h"
+#include "sigen/common/bricked_cube.h"
 #include "sigen/common/image_sequence.h"
+#include "sigen/common/run_length_cube.h"
 namespace sigen {
+// Slices may be 8-bit, 16-bit or 32-bit float grayscale images.
+// Foreground voxels are those greater than `thresh`.
 class Binarizer {
 public:
-  BinaryCube Binarize(const ImageSequence &is, const int thresh);
+  BinaryCube Binarize(const ImageSequence &is, const double thresh);
+  // Binarizes `is` into a preallocated (e.g. memory-mapped) cube.
+  void Binarize(const ImageSequence &is, const double thresh, BinaryCube &cube);
+  // overwrites slice z of `cube`
+  void BinarizeSlice(const cv::Mat &image, const int z, const double thresh, BinaryCube &cube);
+  void BinarizeSlice(const cv::Mat &image, const int z, const double thresh, BrickedCube &cube);
+  // appends slice z to `cube` (slices must come in ascending order of z)
+  void BinarizeSlice(const cv::Mat &image, const int z, const double thresh, RunLengthCube &cube);
+  // same as Binarize, but emits runs directly (for sparse volumes)
+  RunLengthCube BinarizeRunLength(const ImageSequence &is, const double thresh);
+  // same as Binarize, but in 8x8x8 bricks
+  BrickedCube BinarizeBricked(const ImageSequence &is, const double thresh);
 };
 }
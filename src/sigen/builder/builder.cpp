@@ -12,63 +12,90 @@
 #include <utility>
 #include <vector>
 namespace sigen {
+// Maps voxels to cluster indexes.
+// Voxels are grouped into 8x8x8 bricks, so only occupied bricks are stored
+// and most of the 26 neighbors of a voxel are found in the same brick.
+class ClusterIndexGrid {
+  std::map<IPoint, std::vector<int> > bricks_;
+
+public:
+  // cluster indexes of a brick, or NULL if no voxel belongs to it
+  const std::vector<int> *FindBrick(const int x, const int y, const int z) const {
+    std::map<IPoint, std::vector<int> >::const_iterator it = bricks_.find(IPoint(x >> 3, y >> 3, z >> 3));
+    return it == bricks_.end() ? NULL : &it->second;
+  }
+  void Insert(const IPoint &p, const int index) {
+    std::vector<int> &brick = bricks_[IPoint(p.x_ >> 3, p.y_ >> 3, p.z_ >> 3)];
+    if (brick.empty())
+      brick.assign(512, -1);
+    // clusters do not share voxels
+    assert(brick[offset(p.x_, p.y_, p.z_)] == -1);
+    brick[offset(p.x_, p.y_, p.z_)] = index;
+  }
+  static int offset(const int x, const int y, const int z) {
+    return ((z & 7) << 6) | ((y & 7) << 3) | (x & 7);
+  }
+};
+
 void Builder::ConnectNeighbors() {
-  std::multimap<IPoint, int> coord_to_index;
-  for (int i = 0; i < (int)data_.size(); ++i) {
-    BOOST_FOREACH (const IPoint &p, data_[i]->points_) {
-      coord_to_index.insert(std::make_pair(p, i));
+  ClusterIndexGrid grid;
+  for (int i = 0; i < data_.size(); ++i) {
+    for (int k = 0; k < data_.NumPoints(i); ++k) {
+      grid.Insert(data_.Point(i, k), i);
     }
   }
-  for (int i = 0; i < (int)data_.size(); ++i) {
-    BOOST_FOREACH (const IPoint &p, data_[i]->points_) {
+  data_.edges_.clear();
+  for (int i = 0; i < data_.size(); ++i) {
+    for (int k = 0; k < data_.NumPoints(i); ++k) {
+      const IPoint &p = data_.Point(i, k);
+      const std::vector<int> *home = grid.FindBrick(p.x_, p.y_, p.z_);
       for (int dx = -1; dx <= 1; ++dx) {
         for (int dy = -1; dy <= 1; ++dy) {
           for (int dz = -1; dz <= 1; ++dz) {
-            const IPoint q(p.x_ + dx, p.y_ + dy, p.z_ + dz);
-            typedef std::multimap<IPoint, int>::iterator iter_type;
-            std::pair<iter_type, iter_type> range = coord_to_index.equal_range(q);
-            for (iter_type it = range.first; it != range.second; ++it) {
-              if (it->second != i && data_[i]->HasConnection(data_[it->second]) == false) {
-                data_[i]->AddConnection(data_[it->second]);
-              }
+            const int x = p.x_ + dx, y = p.y_ + dy, z = p.z_ + dz;
+            const bool same_brick = (x >> 3) == (p.x_ >> 3) && (y >> 3) == (p.y_ >> 3) && (z >> 3) == (p.z_ >> 3);
+            const std::vector<int> *brick = same_brick ? home : grid.FindBrick(x, y, z);
+            if (brick == NULL)
+              continue;
+            const int j = (*brick)[ClusterIndexGrid::offset(x, y, z)];
+            if (j != -1 && i < j) {
+              data_.edges_.push_back(std::make_pair(i, j));
             }
           }
         }
       }
     }
   }
+  std::sort(data_.edges_.begin(), data_.edges_.end());
+  data_.edges_.erase(std::unique(data_.edges_.begin(), data_.edges_.end()), data_.edges_.end());
+  data_.has_edges_ = true;
 }
 
 void Builder::CutLoops() {
   assert(is_radius_computed_);
   // use kruskal like algorithm
   // see https://en.wikipedia.org/wiki/Kruskal%27s_algorithm
-  DisjointSet<Cluster *> U;
-  typedef std::pair<double, std::pair<Cluster *, Cluster *> > item_type;
+  DisjointSetInternal U(data_.size());
+  typedef std::pair<double, std::pair<int, int> > item_type;
   std::vector<item_type> E;
-  BOOST_FOREACH (ClusterPtr cls, data_) {
-    U.Add(cls.get());
-    BOOST_FOREACH (Cluster *adj, cls->adjacent_) {
-      double strength = (cls->radius_ + adj->radius_) / 2.0;
-      Cluster *a = cls.get(), *b = adj;
-      if (a < b) {
-        E.push_back(std::make_pair(strength, std::make_pair(cls.get(), adj)));
-      }
-    }
+  E.reserve(data_.edges_.size());
+  for (int k = 0; k < (int)data_.edges_.size(); ++k) {
+    const int a = data_.edges_[k].first, b = data_.edges_[k].second;
+    double strength = (data_.radius_[a] + data_.radius_[b]) / 2.0;
+    E.push_back(std::make_pair(strength, data_.edges_[k]));
   }
-  U.SetUp();
   std::sort(E.begin(), E.end());
   std::reverse(E.begin(), E.end());
+  data_.edges_.clear();
   BOOST_FOREACH (const item_type &it, E) {
-    Cluster *a = it.second.first;
-    Cluster *b = it.second.second;
-    if (U.IsSame(a, b)) {
-      a->RemoveConnection(b);
-      b->RemoveConnection(a);
-    } else {
+    const int a = it.second.first;
+    const int b = it.second.second;
+    if (!U.Same(a, b)) {
       U.Merge(a, b);
+      data_.edges_.push_back(it.second);
     }
   }
+  std::sort(data_.edges_.begin(), data_.edges_.end());
 }
 
 static NeuronNode *findEdgeNode(NeuronNode *node) {
@@ -95,76 +122,96 @@ static NeuronNode *findEdgeNode(NeuronNode *node) {
 }
 
 void Builder::ComputeGravityPoints() {
-  BOOST_FOREACH (ClusterPtr cls, data_) {
-    cls->UpdateGravityPoint();
+  const int n = data_.size();
+  data_.gx_.resize(n);
+  data_.gy_.resize(n);
+  data_.gz_.resize(n);
+  for (int i = 0; i < n; ++i) {
+    assert(data_.NumPoints(i) > 0);
+    double sx = 0.0, sy = 0.0, sz = 0.0;
+    for (int k = 0; k < data_.NumPoints(i); ++k) {
+      const IPoint &p = data_.Point(i, k);
+      sx += p.x_;
+      sy += p.y_;
+      sz += p.z_;
+    }
+    data_.gx_[i] = sx / data_.NumPoints(i);
+    data_.gy_[i] = sy / data_.NumPoints(i);
+    data_.gz_[i] = sz / data_.NumPoints(i);
   }
 }
 
 void Builder::ComputeRadius() {
-  BOOST_FOREACH (ClusterPtr cls, data_) {
-    cls->UpdateRadius(scale_xy_, scale_z_);
+  assert((int)data_.gx_.size() == data_.size());
+  const int n = data_.size();
+  data_.radius_.resize(n);
+  for (int i = 0; i < n; ++i) {
+    double mx = 0.0;
+    for (int k = 0; k < data_.NumPoints(i); ++k) {
+      const IPoint &p = data_.Point(i, k);
+      double dx = scale_xy_ * (p.x_ - data_.gx_[i]);
+      double dy = scale_xy_ * (p.y_ - data_.gy_[i]);
+      double dz = scale_z_ * (p.z_ - data_.gz_[i]);
+      mx = std::max(mx, std::sqrt(dx * dx + dy * dy + dz * dz));
+    }
+    data_.radius_[i] = mx;
   }
+  data_.has_summary_ = true;
   is_radius_computed_ = true;
 }
 
+// The nodes share one block (see MakeNeuronNodes). Edges are in ascending
+// order, so each neighbor is appended to the end of adjacent_.
 std::vector<NeuronNodePtr> Builder::ConvertToNeuronNodes() {
-  std::vector<NeuronNodePtr> neuron_nodes;
-  BOOST_FOREACH (ClusterPtr p, data_) {
-    NeuronNodePtr n = boost::make_shared<NeuronNode>();
-    n->setCoord(p->gx_ * scale_xy_,
-                p->gy_ * scale_xy_,
-                p->gz_ * scale_z_);
-    n->radius_ = p->radius_;
-    neuron_nodes.push_back(n);
-  }
-  std::map<Cluster *, int> ptr2index;
-  for (int i = 0; i < (int)data_.size(); ++i) {
-    ptr2index[data_[i].get()] = i;
-  }
-  for (int i = 0; i < (int)data_.size(); ++i) {
-    BOOST_FOREACH (Cluster *p, data_[i]->adjacent_) {
-      int j = ptr2index[p];
-      if (i < j) {
-        neuron_nodes[i]->AddConnection(neuron_nodes[j]);
-        neuron_nodes[j]->AddConnection(neuron_nodes[i]);
-      }
-    }
+  std::vector<NeuronNodePtr> neuron_nodes = MakeNeuronNodes(data_.size());
+  for (int i = 0; i < data_.size(); ++i) {
+    NeuronNode *n = neuron_nodes[i].get();
+    n->setCoord(data_.gx_[i] * scale_xy_,
+                data_.gy_[i] * scale_xy_,
+                data_.gz_[i] * scale_z_);
+    n->radius_ = data_.radius_[i];
+  }
+  for (int k = 0; k < (int)data_.edges_.size(); ++k) {
+    const int i = data_.edges_[k].first, j = data_.edges_[k].second;
+    neuron_nodes[i]->AddConnection(neuron_nodes[j]);
+    neuron_nodes[j]->AddConnection(neuron_nodes[i]);
   }
   return neuron_nodes;
 }
 
+// Nodes are in one block, so a node is found from its address by index.
 std::vector<Neuron> Builder::ConvertToNeuron() {
   std::vector<NeuronNodePtr> neuron_nodes = ConvertToNeuronNodes();
   // split into some neurons
-  std::set<NeuronNode *> used;
+  std::vector<char> used(neuron_nodes.size(), false);
   std::vector<Neuron> neurons;
-  std::map<NeuronNode *, NeuronNodePtr> ptr2smartptr;
+  if (neuron_nodes.empty())
+    return neurons;
+  const NeuronNode *base = neuron_nodes[0].get();
 
-  BOOST_FOREACH (NeuronNodePtr p, neuron_nodes) {
-    ptr2smartptr[p.get()] = p;
-  }
-
-  BOOST_FOREACH (NeuronNodePtr node, neuron_nodes) {
-    if (used.count(node.get())) {
+  for (int i = 0; i < (int)neuron_nodes.size(); ++i) {
+    if (used[i]) {
       continue;
     }
     // FIXME
+    NeuronNode *node = neuron_nodes[i].get();
     neurons.push_back(Neuron());
     Neuron &n = neurons.back();
-    n.set_root(findEdgeNode(node.get()));
-    n.AddNode(node);
+    n.set_root(findEdgeNode(node));
+    n.AddNode(neuron_nodes[i]);
     std::stack<NeuronNode *> stk;
-    stk.push(node.get());
-    used.insert(node.get());
+    stk.push(node);
+    used[i] = true;
     while (!stk.empty()) {
       NeuronNode *cur = stk.top();
       stk.pop();
       BOOST_FOREACH (NeuronNode *next, cur->adjacent_) {
         // If next != parent
-        if (!used.count(next)) {
-          n.AddNode(ptr2smartptr[next]);
+        const int j = next - base;
+        if (!used[j]) {
+          n.AddNode(neuron_nodes[j]);
           stk.push(next);
-          used.insert(next);
+          used[j] = true;
         }
       }
     }
@@ -205,15 +252,21 @@ void Builder::ComputeNodeTypes(std::vector<Neuron> &neurons) {
 
 std::vector<Neuron> Builder::Build() {
   bool print_progress = true;
-  ComputeGravityPoints();
-  if (print_progress)
-    std::cerr << "compute_gravity_point" << std::endl;
-  ComputeRadius();
-  if (print_progress)
-    std::cerr << "compute_radius" << std::endl;
-  ConnectNeighbors();
-  if (print_progress)
-    std::cerr << "connect_neighbor" << std::endl;
+  if (data_.has_summary_) {
+    is_radius_computed_ = true;
+  } else {
+    ComputeGravityPoints();
+    if (print_progress)
+      std::cerr << "compute_gravity_point" << std::endl;
+    ComputeRadius();
+    if (print_progress)
+      std::cerr << "compute_radius" << std::endl;
+  }
+  if (!data_.has_edges_) {
+    ConnectNeighbors();
+    if (print_progress)
+      std::cerr << "connect_neighbor" << std::endl;
+  }
   CutLoops();
   if (print_progress)
     std::cerr << "cut_loops" << std::endl;
@@ -1,5 +1,5 @@
 #pragma once
-#include "sigen/common/cluster.h"
+#include "sigen/common/cluster_store.h"
 #include "sigen/common/neuron.h"
 #include <boost/utility.hpp>
 #include <vector>
@@ -9,18 +9,26 @@ class Builder : boost::noncopyable {
   const double scale_xy_, scale_z_;
 
 public:
-  std::vector<ClusterPtr> data_;
-  explicit Builder(const std::vector<ClusterPtr> &data,
+  ClusterStore data_;
+  explicit Builder(const ClusterStore &data,
                    const double scale_xy,
                    const double scale_z)
       : is_radius_computed_(false), scale_xy_(scale_xy), scale_z_(scale_z), data_(data) {}
+  // takes over the clusters, e.g. Builder bld(boost::move(clusters), ...)
+  explicit Builder(BOOST_RV_REF(ClusterStore) data,
+                   const double scale_xy,
+                   const double scale_z)
+      : is_radius_computed_(false), scale_xy_(scale_xy), scale_z_(scale_z), data_(boost::move(data)) {}
   std::vector<Neuron> Build();
   std::vector<Neuron> ConvertToNeuron();
   std::vector<NeuronNodePtr> ConvertToNeuronNodes();
   static void ComputeNodeTypes(std::vector<Neuron> &neurons);
   static void ComputeIds(std::vector<Neuron> &neurons);
+  // Fills data_.edges_. Build() skips it if Extractor already did.
   void ConnectNeighbors();
   void CutLoops();
+  // Fill data_.gx_, gy_, gz_ and radius_ from the points. Build() skips
+  // them if Extractor already did (see Extractor::summarize_).
   void ComputeGravityPoints();
   void ComputeRadius();
 };
@@ -0,0 +1,96 @@
+#include "sigen/common/binary_cube.h"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/static_assert.hpp>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+namespace sigen {
+namespace {
+// On-disk layout: this header (native byte order), then the words of
+// BinaryCube in memory order. The header is padded to 64 bytes, so the
+// words stay cache-line aligned in the mapping.
+struct CubeFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t layout; // 0: x-fastest packed rows
+  int32_t x, y, z;
+  int32_t words_per_row;
+  char reserved[32];
+};
+BOOST_STATIC_ASSERT(sizeof(CubeFileHeader) == 64);
+const char kMagic[8] = {'S', 'I', 'G', 'E', 'N', 'B', 'C', '\0'};
+const uint32_t kVersion = 1;
+} // namespace
+
+class MappedCubeFile {
+public:
+  boost::interprocess::file_mapping file_;
+  boost::interprocess::mapped_region region_;
+  MappedCubeFile(const std::string &path, boost::interprocess::mode_t mode)
+      : file_(path.c_str(), mode), region_(file_, mode) {}
+  uint64_t *words() {
+    return (uint64_t *)((char *)region_.get_address() + sizeof(CubeFileHeader));
+  }
+};
+
+BinaryCube BinaryCube::CreateMapped(const std::string &path, int x, int y, int z) {
+  BinaryCube cube(0, 0, 0);
+  cube.words_per_row_ = (x + 63) / 64;
+  cube.x_ = x;
+  cube.y_ = y;
+  cube.z_ = z;
+
+  CubeFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.layout = 0;
+  header.x = x;
+  header.y = y;
+  header.z = z;
+  header.words_per_row = cube.words_per_row_;
+  {
+    // the file is extended without writing the words (they read as zero)
+    std::filebuf fbuf;
+    if (!fbuf.open(path.c_str(), std::ios_base::in | std::ios_base::out | std::ios_base::trunc | std::ios_base::binary))
+      throw std::runtime_error("cannot create " + path);
+    fbuf.sputn((const char *)&header, sizeof(header));
+    const std::streamoff size = sizeof(header) + cube.numWords() * sizeof(uint64_t);
+    fbuf.pubseekoff(size - 1, std::ios_base::beg);
+    fbuf.sputc(0);
+  }
+  cube.file_ = boost::make_shared<MappedCubeFile>(path, boost::interprocess::read_write);
+  cube.words_ = cube.file_->words();
+  return cube;
+}
+
+BinaryCube BinaryCube::OpenMapped(const std::string &path, bool read_only) {
+  namespace ip = boost::interprocess;
+  boost::shared_ptr<MappedCubeFile> file =
+      boost::make_shared<MappedCubeFile>(path, read_only ? ip::read_only : ip::read_write);
+  if (file->region_.get_size() < sizeof(CubeFileHeader))
+    throw std::runtime_error(path + " is not a cube file");
+  const CubeFileHeader &header = *(const CubeFileHeader *)file->region_.get_address();
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion || header.layout != 0 ||
+      header.words_per_row != (header.x + 63) / 64)
+    throw std::runtime_error(path + " is not a cube file");
+  BinaryCube cube(0, 0, 0);
+  cube.words_per_row_ = header.words_per_row;
+  cube.x_ = header.x;
+  cube.y_ = header.y;
+  cube.z_ = header.z;
+  if (file->region_.get_size() < sizeof(CubeFileHeader) + cube.numWords() * sizeof(uint64_t))
+    throw std::runtime_error(path + " is truncated");
+  cube.file_ = file;
+  cube.words_ = file->words();
+  return cube;
+}
+
+void BinaryCube::Flush() {
+  if (file_)
+    file_->region_.flush();
+}
+} // namespace sigen
@@ -1,24 +1,124 @@
 #pragma once
+#include <algorithm>
+#include <boost/move/core.hpp>
+#include <boost/move/utility_core.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cassert>
+#include <stdint.h>
+#include <string>
 #include <vector>
 namespace sigen {
+inline int CountTrailingZeros(const uint64_t w) {
+  assert(w != 0);
+#if defined(__GNUC__)
+  return __builtin_ctzll(w);
+#else
+  int n = 0;
+  while (((w >> n) & 1) == 0)
+    ++n;
+  return n;
+#endif
+}
+
+class MappedCubeFile;
+
 // this class represents bool[][][]
+// Bits are packed into 64-bit words along x. Each (y, z) row occupies
+// `WordsPerRow()` consecutive words, and rows are stored y-fastest, so a
+// z-slice is one contiguous block (the same order as OpenCV / Vaa3D buffers).
+//
+// The words live either in memory or in a memory-mapped file (see
+// CreateMapped / OpenMapped), in which case the OS page cache decides what
+// is resident. Copying a mapped cube copies it into memory; move it instead.
 class BinaryCube {
+  BOOST_COPYABLE_AND_MOVABLE(BinaryCube)
+  int words_per_row_;
+  std::vector<uint64_t> data_;
+  uint64_t *words_; // &data_[0] or the mapped words
+  boost::shared_ptr<MappedCubeFile> file_;
+
+  size_t numWords() const { return (size_t)words_per_row_ * y_ * z_; }
+  void resetWords() { words_ = data_.empty() ? NULL : &data_[0]; }
+
 public:
   int x_, y_, z_;
-  std::vector<std::vector<std::vector<bool> > > data_;
   BinaryCube(int x, int y, int z)
-      : x_(x), y_(y), z_(z),
-        data_(x, std::vector<std::vector<bool> >(y, std::vector<bool>(z))) {}
-  // setter
-  std::vector<std::vector<bool> > &operator[](int index) {
-    return data_[index];
+      : words_per_row_((x + 63) / 64),
+        data_((size_t)words_per_row_ * y * z, 0),
+        x_(x), y_(y), z_(z) {
+    resetWords();
   }
-  // getter
-  const std::vector<std::vector<bool> > &operator[](int index) const {
-    return data_[index];
+  BinaryCube(const BinaryCube &other)
+      : words_per_row_(other.words_per_row_),
+        data_(other.words_, other.words_ + other.numWords()),
+        x_(other.x_), y_(other.y_), z_(other.z_) {
+    resetWords();
   }
+  BinaryCube(BOOST_RV_REF(BinaryCube) other)
+      : words_per_row_(0), words_(NULL), x_(0), y_(0), z_(0) {
+    Swap(other);
+  }
+  BinaryCube &operator=(BOOST_COPY_ASSIGN_REF(BinaryCube) other) {
+    if (this != &other) {
+      BinaryCube tmp(other);
+      Swap(tmp);
+    }
+    return *this;
+  }
+  BinaryCube &operator=(BOOST_RV_REF(BinaryCube) other) {
+    if (this != &other) {
+      Clear();
+      Swap(other);
+    }
+    return *this;
+  }
+  void Swap(BinaryCube &other) {
+    std::swap(words_per_row_, other.words_per_row_);
+    data_.swap(other.data_); // keeps the buffers, so words_ stays valid
+    std::swap(words_, other.words_);
+    file_.swap(other.file_);
+    std::swap(x_, other.x_);
+    std::swap(y_, other.y_);
+    std::swap(z_, other.z_);
+  }
+
+  // Creates `path` holding an empty cube, and maps it read-write.
+  static BinaryCube CreateMapped(const std::string &path, int x, int y, int z);
+  // Maps a file written by CreateMapped.
+  // Writing to a read-only cube is undefined behavior.
+  static BinaryCube OpenMapped(const std::string &path, bool read_only);
+  bool IsMapped() const { return (bool)file_; }
+  // writes dirty pages of a mapped cube back to the file
+  void Flush();
+
+  int WordsPerRow() const { return words_per_row_; }
+  // bits beyond x_ in the last word of a row are always zero
+  uint64_t *Row(const int y, const int z) {
+    return words_ + ((size_t)z * y_ + y) * words_per_row_;
+  }
+  const uint64_t *Row(const int y, const int z) const {
+    return words_ + ((size_t)z * y_ + y) * words_per_row_;
+  }
+  bool Get(const int x, const int y, const int z) const {
+    assert(0 <= x && x < x_ && 0 <= y && y < y_ && 0 <= z && z < z_);
+    return (Row(y, z)[x >> 6] >> (x & 63)) & 1;
+  }
+  void Set(const int x, const int y, const int z, const bool value) {
+    assert(0 <= x && x < x_ && 0 <= y && y < y_ && 0 <= z && z < z_);
+    const uint64_t mask = (uint64_t)1 << (x & 63);
+    if (value)
+      Row(y, z)[x >> 6] |= mask;
+    else
+      Row(y, z)[x >> 6] &= ~mask;
+  }
+  // releases the buffer or unmaps the file (the file itself is kept)
   void Clear() {
-    data_.clear();
+    // std::vector::clear keeps the capacity
+    std::vector<uint64_t>().swap(data_);
+    file_.reset();
+    words_ = NULL;
+    words_per_row_ = 0;
+    x_ = y_ = z_ = 0;
   }
 };
 } // namespace sigen
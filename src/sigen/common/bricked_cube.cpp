@@ -0,0 +1,69 @@
+#include "sigen/common/bricked_cube.h"
+#include <algorithm>
+namespace sigen {
+BrickedCube::BrickedCube(const BinaryCube &cube)
+    : bx_((cube.x_ + 7) / 8), by_((cube.y_ + 7) / 8), bz_((cube.z_ + 7) / 8),
+      data_((size_t)bx_ * by_ * bz_ * 8, 0),
+      population_((size_t)bx_ * by_ * bz_, 0),
+      x_(cube.x_), y_(cube.y_), z_(cube.z_) {
+  for (int z = 0; z < z_; ++z) {
+    for (int y = 0; y < y_; ++y) {
+      const uint64_t *row = cube.Row(y, z);
+      for (int i = 0; i < cube.WordsPerRow(); ++i) {
+        if (row[i] == 0)
+          continue;
+        // one word of a row covers 8 bricks
+        for (int k = 0; k < 8 && i * 8 + k < bx_; ++k) {
+          const uint64_t byte = (row[i] >> (k * 8)) & 0xff;
+          if (byte == 0)
+            continue;
+          const int index = BrickIndex(i * 8 + k, y >> 3, z >> 3);
+          data_[(size_t)index * 8 + (z & 7)] |= byte << ((y & 7) * 8);
+          population_[index] += PopCount(byte);
+        }
+      }
+    }
+  }
+}
+
+void BrickedCube::Swap(BrickedCube &other) {
+  std::swap(bx_, other.bx_);
+  std::swap(by_, other.by_);
+  std::swap(bz_, other.bz_);
+  data_.swap(other.data_);
+  population_.swap(other.population_);
+  std::swap(x_, other.x_);
+  std::swap(y_, other.y_);
+  std::swap(z_, other.z_);
+}
+
+long long BrickedCube::CountVoxels() const {
+  long long n = 0;
+  for (int i = 0; i < (int)population_.size(); ++i) {
+    n += population_[i];
+  }
+  return n;
+}
+
+BinaryCube BrickedCube::ToBinaryCube() const {
+  BinaryCube cube(x_, y_, z_);
+  for (int z = 0; z < z_; ++z) {
+    for (int y = 0; y < y_; ++y) {
+      uint64_t *row = cube.Row(y, z);
+      for (int bx = 0; bx < bx_; ++bx) {
+        if (IsEmpty(BrickIndex(bx, y >> 3, z >> 3)))
+          continue;
+        row[bx >> 3] |= (uint64_t)RowByte(bx, y, z) << ((bx & 7) * 8);
+      }
+    }
+  }
+  return cube;
+}
+
+void BrickedCube::Clear() {
+  std::vector<uint64_t>().swap(data_);
+  std::vector<uint16_t>().swap(population_);
+  bx_ = by_ = bz_ = 0;
+  x_ = y_ = z_ = 0;
+}
+} // namespace sigen
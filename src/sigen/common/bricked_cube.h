@@ -0,0 +1,114 @@
+#pragma once
+#include "sigen/common/binary_cube.h"
+#include <boost/move/core.hpp>
+#include <boost/move/utility_core.hpp>
+#include <cassert>
+#include <stdint.h>
+#include <vector>
+namespace sigen {
+inline int PopCount(uint64_t w) {
+#if defined(__GNUC__)
+  return __builtin_popcountll(w);
+#else
+  int n = 0;
+  for (; w != 0; w &= w - 1)
+    ++n;
+  return n;
+#endif
+}
+
+// Bricked representation of bool[][][].
+// The volume is split into 8x8x8 bricks of 512 bits (one cache line).
+// Word k of a brick holds layer z = 8 * bz + k, and bit (8 * ly + lx) of a
+// word holds (x, y) = (8 * bx + lx, 8 * by + ly). The number of foreground
+// voxels of every brick is kept up to date, so empty bricks can be skipped.
+class BrickedCube {
+  BOOST_COPYABLE_AND_MOVABLE(BrickedCube)
+  int bx_, by_, bz_;
+  std::vector<uint64_t> data_;
+  std::vector<uint16_t> population_;
+
+public:
+  static const int kBrickSize = 8;
+  int x_, y_, z_;
+  BrickedCube(int x, int y, int z)
+      : bx_((x + 7) / 8), by_((y + 7) / 8), bz_((z + 7) / 8),
+        data_((size_t)bx_ * by_ * bz_ * 8, 0),
+        population_((size_t)bx_ * by_ * bz_, 0),
+        x_(x), y_(y), z_(z) {}
+  explicit BrickedCube(const BinaryCube &cube);
+  BrickedCube(const BrickedCube &other)
+      : bx_(other.bx_), by_(other.by_), bz_(other.bz_),
+        data_(other.data_), population_(other.population_),
+        x_(other.x_), y_(other.y_), z_(other.z_) {}
+  BrickedCube(BOOST_RV_REF(BrickedCube) other)
+      : bx_(0), by_(0), bz_(0), x_(0), y_(0), z_(0) {
+    Swap(other);
+  }
+  BrickedCube &operator=(BOOST_COPY_ASSIGN_REF(BrickedCube) other) {
+    if (this != &other) {
+      BrickedCube tmp(other);
+      Swap(tmp);
+    }
+    return *this;
+  }
+  BrickedCube &operator=(BOOST_RV_REF(BrickedCube) other) {
+    if (this != &other) {
+      Clear();
+      Swap(other);
+    }
+    return *this;
+  }
+  void Swap(BrickedCube &other);
+
+  int BricksX() const { return bx_; }
+  int BricksY() const { return by_; }
+  int BricksZ() const { return bz_; }
+  int BrickIndex(const int bx, const int by, const int bz) const {
+    return (bz * by_ + by) * bx_ + bx;
+  }
+  // 8 words, one per layer
+  const uint64_t *Brick(const int index) const { return &data_[(size_t)index * 8]; }
+  int Population(const int index) const { return population_[index]; }
+  bool IsEmpty(const int index) const { return population_[index] == 0; }
+
+  bool Get(const int x, const int y, const int z) const {
+    assert(0 <= x && x < x_ && 0 <= y && y < y_ && 0 <= z && z < z_);
+    const uint64_t w = data_[(size_t)BrickIndex(x >> 3, y >> 3, z >> 3) * 8 + (z & 7)];
+    return (w >> (((y & 7) << 3) | (x & 7))) & 1;
+  }
+  // out-of-range coordinates are background
+  bool GetOrFalse(const int x, const int y, const int z) const {
+    if (x < 0 || x >= x_ || y < 0 || y >= y_ || z < 0 || z >= z_)
+      return false;
+    return Get(x, y, z);
+  }
+  void Set(const int x, const int y, const int z, const bool value) {
+    assert(0 <= x && x < x_ && 0 <= y && y < y_ && 0 <= z && z < z_);
+    const int index = BrickIndex(x >> 3, y >> 3, z >> 3);
+    uint64_t &w = data_[(size_t)index * 8 + (z & 7)];
+    const uint64_t mask = (uint64_t)1 << (((y & 7) << 3) | (x & 7));
+    if (value && !(w & mask)) {
+      w |= mask;
+      population_[index]++;
+    } else if (!value && (w & mask)) {
+      w &= ~mask;
+      population_[index]--;
+    }
+  }
+  // Overwrite layer `lz` of a brick and keep the population up to date.
+  void SetLayer(const int index, const int lz, const uint64_t w) {
+    uint64_t &old = data_[(size_t)index * 8 + lz];
+    population_[index] += PopCount(w) - PopCount(old);
+    old = w;
+  }
+  // 8 bits of row (y, z) starting at x = 8 * bx
+  int RowByte(const int bx, const int y, const int z) const {
+    const uint64_t w = data_[(size_t)BrickIndex(bx, y >> 3, z >> 3) * 8 + (z & 7)];
+    return (int)((w >> ((y & 7) << 3)) & 0xff);
+  }
+  long long CountVoxels() const;
+  BinaryCube ToBinaryCube() const;
+  void Clear();
+};
+} // namespace sigen
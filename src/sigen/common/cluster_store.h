@@ -0,0 +1,117 @@
+#pragma once
+#include "sigen/common/point.h"
+#include <algorithm>
+#include <boost/move/core.hpp>
+#include <boost/move/utility_core.hpp>
+#include <cassert>
+#include <utility>
+#include <vector>
+namespace sigen {
+// Every cluster of an extraction, in structure-of-arrays form.
+// Clusters are identified by their index. The points of cluster i are
+// points_[offsets_[i], offsets_[i + 1]), so all points share one array,
+// and per-cluster values (filled by Builder) are parallel arrays.
+// The adjacency of clusters is an edge list, filled by Extractor or by
+// Builder::ConnectNeighbors. A summarized store (see Extractor::summarize_)
+// keeps no points, only the per-cluster values.
+class ClusterStore {
+  BOOST_COPYABLE_AND_MOVABLE(ClusterStore)
+
+public:
+  std::vector<IPoint> points_;
+  std::vector<int> offsets_;
+  // gravity point and radius (in scaled units) of each cluster
+  std::vector<double> gx_, gy_, gz_;
+  std::vector<double> radius_;
+  // set if gx_, gy_, gz_ and radius_ are filled
+  bool has_summary_;
+  // adjacent clusters (i, j), i < j, in ascending order, if has_edges_
+  std::vector<std::pair<int, int> > edges_;
+  bool has_edges_;
+
+  ClusterStore() : offsets_(1, 0), has_summary_(false), has_edges_(false) {}
+  ClusterStore(const ClusterStore &other)
+      : points_(other.points_), offsets_(other.offsets_),
+        gx_(other.gx_), gy_(other.gy_), gz_(other.gz_), radius_(other.radius_),
+        has_summary_(other.has_summary_), edges_(other.edges_), has_edges_(other.has_edges_) {}
+  ClusterStore(BOOST_RV_REF(ClusterStore) other) : offsets_(1, 0), has_summary_(false), has_edges_(false) {
+    Swap(other);
+  }
+  ClusterStore &operator=(BOOST_COPY_ASSIGN_REF(ClusterStore) other) {
+    if (this != &other) {
+      ClusterStore tmp(other);
+      Swap(tmp);
+    }
+    return *this;
+  }
+  ClusterStore &operator=(BOOST_RV_REF(ClusterStore) other) {
+    if (this != &other) {
+      Clear();
+      Swap(other);
+    }
+    return *this;
+  }
+  void Swap(ClusterStore &other) {
+    points_.swap(other.points_);
+    offsets_.swap(other.offsets_);
+    gx_.swap(other.gx_);
+    gy_.swap(other.gy_);
+    gz_.swap(other.gz_);
+    radius_.swap(other.radius_);
+    std::swap(has_summary_, other.has_summary_);
+    edges_.swap(other.edges_);
+    std::swap(has_edges_, other.has_edges_);
+  }
+
+  int size() const { return (int)offsets_.size() - 1; }
+  bool empty() const { return size() == 0; }
+  int NumPoints(const int i) const { return offsets_[i + 1] - offsets_[i]; }
+  const IPoint &Point(const int i, const int k) const {
+    assert(0 <= k && k < NumPoints(i));
+    return points_[offsets_[i] + k];
+  }
+  // the points added to points_ since the last call become a cluster
+  void CloseCluster() {
+    assert((int)points_.size() > offsets_.back());
+    offsets_.push_back(points_.size());
+  }
+  // a cluster of no points, only its gravity point and radius
+  void AddSummary(const double gx, const double gy, const double gz, const double radius) {
+    offsets_.push_back(offsets_.back());
+    gx_.push_back(gx);
+    gy_.push_back(gy);
+    gz_.push_back(gz);
+    radius_.push_back(radius);
+  }
+  // Appends the clusters (points, per-cluster values and edges) of `other`.
+  // Edges stay in ascending order, as clusters of `other` come after those
+  // of this store.
+  void Append(const ClusterStore &other) {
+    const int base = points_.size(), base_index = size();
+    points_.insert(points_.end(), other.points_.begin(), other.points_.end());
+    for (int i = 1; i < (int)other.offsets_.size(); ++i) {
+      offsets_.push_back(base + other.offsets_[i]);
+    }
+    gx_.insert(gx_.end(), other.gx_.begin(), other.gx_.end());
+    gy_.insert(gy_.end(), other.gy_.begin(), other.gy_.end());
+    gz_.insert(gz_.end(), other.gz_.begin(), other.gz_.end());
+    radius_.insert(radius_.end(), other.radius_.begin(), other.radius_.end());
+    for (int i = 0; i < (int)other.edges_.size(); ++i) {
+      edges_.push_back(std::make_pair(base_index + other.edges_[i].first,
+                                      base_index + other.edges_[i].second));
+    }
+  }
+  void Clear() {
+    // std::vector::clear keeps the capacity
+    std::vector<IPoint>().swap(points_);
+    std::vector<int>(1, 0).swap(offsets_);
+    std::vector<double>().swap(gx_);
+    std::vector<double>().swap(gy_);
+    std::vector<double>().swap(gz_);
+    std::vector<double>().swap(radius_);
+    has_summary_ = false;
+    std::vector<std::pair<int, int> >().swap(edges_);
+    has_edges_ = false;
+  }
+};
+} // namespace sigen
@@ -11,10 +11,10 @@ namespace sigen {
 
 class DisjointSetInternal {
   std::vector<int> data;
-  int Root(int x);
 
 public:
   explicit DisjointSetInternal(int size);
+  int Root(int x);
   int Size(int x);
   bool Same(int x, int y);
   void Merge(int x, int y);
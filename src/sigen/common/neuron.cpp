@@ -1,35 +1,54 @@
 #include "sigen/common/neuron.h"
 #include <algorithm>
+#include <boost/checked_delete.hpp>
 #include <boost/foreach.hpp>
 #include <cassert>
 #include <map>
 #include <set>
 namespace sigen {
 
+namespace {
+struct IdIn {
+  const std::set<int> &ids_;
+  explicit IdIn(const std::set<int> &ids) : ids_(ids) {}
+  bool operator()(const NeuronNode *node) const { return ids_.count(node->id_) > 0; }
+};
+} // namespace
+
 void NeuronNode::RemoveConnections(const std::set<int> &nodes) {
-  // `std::set.erase` invalidates iterator. Be careful.
-  // http://qiita.com/satoruhiga/items/fa6eae09c9d89bd48b5d
-  std::set<NeuronNode *>::iterator it = adjacent_.begin();
-  while (it != adjacent_.end()) {
-    if (nodes.count((*it)->id_)) {
-      adjacent_.erase(it++);
-    } else {
-      ++it;
-    }
+  adjacent_.erase(std::remove_if(adjacent_.begin(), adjacent_.end(), IdIn(nodes)), adjacent_.end());
+}
+
+std::vector<NeuronNodePtr> MakeNeuronNodes(const int n) {
+  std::vector<NeuronNodePtr> ret;
+  if (n == 0)
+    return ret;
+  boost::shared_ptr<NeuronNode> block(new NeuronNode[n], boost::checked_array_deleter<NeuronNode>());
+  ret.reserve(n);
+  for (int i = 0; i < n; ++i) {
+    // aliasing constructor: shares the count of `block`
+    ret.push_back(NeuronNodePtr(block, block.get() + i));
   }
+  return ret;
 }
 
 Neuron Neuron::Clone() const {
   assert(this->root_ != NULL);
   Neuron ret;
   std::map<NeuronNode *, int> ptr_to_index;
+  ret.storage_ = MakeNeuronNodes(this->storage_.size());
   for (int i = 0; i < (int)this->storage_.size(); ++i) {
-    NeuronNodePtr ptr = this->storage_[i];
-    ptr_to_index[ptr.get()] = i;
-    ret.storage_.push_back(ptr->Clone());
+    const NeuronNode *src = this->storage_[i].get();
+    NeuronNode *dst = ret.storage_[i].get();
+    ptr_to_index[this->storage_[i].get()] = i;
+    dst->id_ = src->id_;
+    dst->setCoord(src->gx_, src->gy_, src->gz_);
+    dst->radius_ = src->radius_;
+    dst->type_ = src->type_;
   }
 
   for (int i = 0; i < (int)this->storage_.size(); ++i) {
+    ret.storage_[i]->adjacent_.reserve(this->storage_[i]->adjacent_.size());
     BOOST_FOREACH (NeuronNode *adj, this->storage_[i].get()->adjacent_) {
       NeuronNode *p = ret.storage_[ptr_to_index[adj]].get();
       ret.storage_[i]->AddConnection(p);
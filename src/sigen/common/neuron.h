@@ -1,8 +1,10 @@
 #pragma once
+#include <algorithm>
 #include <boost/foreach.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/utility.hpp>
+#include <cassert>
 #include <map>
 #include <set>
 #include <string>
@@ -24,24 +26,30 @@ public:
   double gx_, gy_, gz_;
   double radius_;
   NeuronType::enum_t type_;
-  std::set<NeuronNode *> adjacent_;
+  // in ascending order of address, as a std::set would be; nodes have few
+  // neighbors, so a vector keeps them in one small block
+  std::vector<NeuronNode *> adjacent_;
   // Variant may contain `degree`, `real_distance`, `electrical_distance`
   // std::map<std::string, Variant> values_;
 
+  NeuronNode()
+      : id_(0), gx_(0.0), gy_(0.0), gz_(0.0), radius_(0.0), type_(NeuronType::EDGE) {}
+
   void AddConnection(NeuronNode *node) {
-    assert(!adjacent_.count(node));
-    adjacent_.insert(node);
+    std::vector<NeuronNode *>::iterator it = std::lower_bound(adjacent_.begin(), adjacent_.end(), node);
+    assert(it == adjacent_.end() || *it != node);
+    adjacent_.insert(it, node);
   }
-  void AddConnection(NeuronNodePtr node) {
+  void AddConnection(const NeuronNodePtr &node) {
     this->AddConnection(node.get());
   }
 
   void RemoveConnections(const std::set<int> &nodes);
 
   bool HasConnection(NeuronNode *node) const {
-    return adjacent_.count(node) > 0;
+    return std::binary_search(adjacent_.begin(), adjacent_.end(), node);
   }
-  bool HasConnection(NeuronNodePtr node) const {
+  bool HasConnection(const NeuronNodePtr &node) const {
     return this->HasConnection(node.get());
   }
   void setCoord(const double gx, const double gy, const double gz) {
@@ -77,6 +85,10 @@ public:
     }
   }
 };
+// Allocates `n` nodes in one block. Each pointer shares the ownership of the
+// whole block, which is released at once with the last of them.
+std::vector<NeuronNodePtr> MakeNeuronNodes(int n);
+
 class Neuron /* : noncopyable */ {
   NeuronNode *root_;
 
@@ -87,7 +99,7 @@ public:
 
   NeuronNode *get_root() const { return root_; }
   void set_root(NeuronNode *value) { root_ = value; }
-  void AddNode(NeuronNodePtr node) {
+  void AddNode(const NeuronNodePtr &node) {
     storage_.push_back(node);
   }
   bool IsEmpty() const {
@@ -108,7 +120,7 @@ public:
     root_ = storage_[nth].get();
   }
   void RemoveConnections(const std::set<int> &nodes) {
-    BOOST_FOREACH (NeuronNodePtr p, storage_) {
+    BOOST_FOREACH (const NeuronNodePtr &p, storage_) {
       p->RemoveConnections(nodes);
     }
   }
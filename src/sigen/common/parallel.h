@@ -0,0 +1,23 @@
+#pragma once
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+namespace sigen {
+// Parallel loops use OpenMP when it is enabled, and run serially otherwise.
+inline int GetNumThreads() {
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+// n <= 0 keeps the default (all cores, or OMP_NUM_THREADS)
+inline void SetNumThreads(const int n) {
+#ifdef _OPENMP
+  if (n > 0)
+    omp_set_num_threads(n);
+#else
+  (void)n;
+#endif
+}
+} // namespace sigen
@@ -0,0 +1,171 @@
+#include "sigen/common/run_length_cube.h"
+#include "sigen/common/bricked_cube.h"
+#include <algorithm>
+#include <cassert>
+namespace sigen {
+RunLengthCube::RunLengthCube(const BinaryCube &cube)
+    : x_(cube.x_), y_(cube.y_), z_(cube.z_) {
+  for (int z = 0; z < z_; ++z) {
+    for (int y = 0; y < y_; ++y) {
+      AppendRow(y, z, cube.Row(y, z));
+    }
+  }
+}
+
+RunLengthCube::RunLengthCube(const BrickedCube &cube)
+    : x_(cube.x_), y_(cube.y_), z_(cube.z_) {
+  std::vector<int> occupied;
+  for (int z = 0; z < z_; ++z) {
+    for (int y = 0; y < y_; ++y) {
+      if ((y & 7) == 0) {
+        // non-empty bricks of this brick row
+        occupied.clear();
+        for (int bx = 0; bx < cube.BricksX(); ++bx) {
+          if (!cube.IsEmpty(cube.BrickIndex(bx, y >> 3, z >> 3)))
+            occupied.push_back(bx);
+        }
+      }
+      int begin = -1, prev = -2;
+      for (int i = 0; i < (int)occupied.size(); ++i) {
+        const int bx = occupied[i];
+        if (begin >= 0 && bx != prev + 1) {
+          AppendRun(y, z, begin, (prev + 1) * 8);
+          begin = -1;
+        }
+        prev = bx;
+        const int byte = cube.RowByte(bx, y, z);
+        for (int lx = 0; lx < 8; ++lx) {
+          const bool bit = (byte >> lx) & 1;
+          if (bit && begin < 0) {
+            begin = bx * 8 + lx;
+          } else if (!bit && begin >= 0) {
+            AppendRun(y, z, begin, bx * 8 + lx);
+            begin = -1;
+          }
+        }
+      }
+      if (begin >= 0) {
+        AppendRun(y, z, begin, std::min(x_, (prev + 1) * 8));
+      }
+    }
+  }
+}
+
+void RunLengthCube::Swap(RunLengthCube &other) {
+  row_begin_.swap(other.row_begin_);
+  std::swap(x_, other.x_);
+  std::swap(y_, other.y_);
+  std::swap(z_, other.z_);
+  runs_.swap(other.runs_);
+}
+
+long long RunLengthCube::CountVoxels() const {
+  long long n = 0;
+  for (int i = 0; i < (int)runs_.size(); ++i) {
+    n += runs_[i].size();
+  }
+  return n;
+}
+
+void RunLengthCube::AppendRun(const int y, const int z, const int begin, const int end) {
+  assert(0 <= y && y < y_ && 0 <= z && z < z_);
+  assert(0 <= begin && begin < end && end <= x_);
+  const int r = z * y_ + y;
+  assert(r + 1 >= (int)row_begin_.size());
+  while ((int)row_begin_.size() <= r) {
+    row_begin_.push_back((int)runs_.size());
+  }
+  assert(RowBegin(y, z) == (int)runs_.size() || runs_.back().end_ < begin);
+  runs_.push_back(Run(begin, end));
+}
+
+void RunLengthCube::AppendRow(const int y, const int z, const uint64_t *bits) {
+  const int words = (x_ + 63) / 64;
+  int begin = -1;
+  for (int i = 0; i < words; ++i) {
+    const uint64_t w = bits[i];
+    int pos = 0;
+    while (pos < 64) {
+      if (begin < 0) {
+        // find the next foreground bit
+        const uint64_t m = w >> pos;
+        if (m == 0)
+          break;
+        pos += CountTrailingZeros(m);
+        begin = i * 64 + pos;
+      } else {
+        // find the next background bit
+        const uint64_t m = ~w >> pos;
+        if (m == 0)
+          break;
+        pos += CountTrailingZeros(m);
+        AppendRun(y, z, begin, i * 64 + pos);
+        begin = -1;
+      }
+    }
+  }
+  if (begin >= 0) {
+    AppendRun(y, z, begin, x_);
+  }
+}
+
+void RunLengthCube::AppendSlice(const int z, const RunLengthCube &slice) {
+  assert(slice.x_ == x_ && slice.y_ == y_ && slice.z_ == 1);
+  for (int y = 0; y < y_; ++y) {
+    for (int i = slice.RowBegin(y, 0); i < slice.RowEnd(y, 0); ++i) {
+      AppendRun(y, z, slice.runs_[i].begin_, slice.runs_[i].end_);
+    }
+  }
+}
+
+// the first run in row (y, z) whose end_ is beyond x
+static const Run *findRun(const RunLengthCube &c, const int y, const int z, const int x) {
+  const Run *first = &c.runs_[0] + c.RowBegin(y, z);
+  const Run *last = &c.runs_[0] + c.RowEnd(y, z);
+  // runs are sorted, so end_ is ascending in a row
+  int lo = 0, hi = last - first;
+  while (lo < hi) {
+    const int mid = (lo + hi) / 2;
+    if (first[mid].end_ <= x)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo < last - first ? first + lo : NULL;
+}
+
+bool RunLengthCube::Get(const int x, const int y, const int z) const {
+  assert(0 <= x && x < x_ && 0 <= y && y < y_ && 0 <= z && z < z_);
+  if (runs_.empty())
+    return false;
+  const Run *p = findRun(*this, y, z, x);
+  return p != NULL && p->begin_ <= x;
+}
+
+bool RunLengthCube::AnyInRange(const int y, const int z, const int lo, const int hi) const {
+  if (y < 0 || y >= y_ || z < 0 || z >= z_ || runs_.empty())
+    return false;
+  const Run *p = findRun(*this, y, z, lo);
+  return p != NULL && p->begin_ <= hi;
+}
+
+BinaryCube RunLengthCube::ToBinaryCube() const {
+  BinaryCube cube(x_, y_, z_);
+  for (int z = 0; z < z_; ++z) {
+    for (int y = 0; y < y_; ++y) {
+      for (int i = RowBegin(y, z); i < RowEnd(y, z); ++i) {
+        for (int x = runs_[i].begin_; x < runs_[i].end_; ++x) {
+          cube.Set(x, y, z, true);
+        }
+      }
+    }
+  }
+  return cube;
+}
+
+void RunLengthCube::Clear() {
+  std::vector<int>().swap(row_begin_);
+  std::vector<Run>().swap(runs_);
+  x_ = y_ = z_ = 0;
+}
+} // namespace sigen
@@ -0,0 +1,91 @@
+#pragma once
+#include "sigen/common/binary_cube.h"
+#include <boost/move/core.hpp>
+#include <boost/move/utility_core.hpp>
+#include <cassert>
+#include <stdint.h>
+#include <vector>
+namespace sigen {
+class BrickedCube;
+
+// foreground voxels [begin_, end_) along x in one (y, z) row
+struct Run {
+  int begin_, end_;
+  Run(const int begin, const int end) : begin_(begin), end_(end) {}
+  int size() const { return end_ - begin_; }
+};
+
+// Sparse representation of bool[][][] as maximal runs of foreground.
+// Runs are stored in raster order (x-fastest, then y, then z), and
+// `row_begin_` indexes the first run of every row, so memory and scans
+// scale with the number of runs instead of the volume.
+class RunLengthCube {
+  BOOST_COPYABLE_AND_MOVABLE(RunLengthCube)
+  // row_begin_[r] is the first run of row r = z * y_ + y.
+  // Rows beyond row_begin_.size() have not been appended yet.
+  std::vector<int> row_begin_;
+
+public:
+  int x_, y_, z_;
+  std::vector<Run> runs_;
+
+  RunLengthCube() : x_(0), y_(0), z_(0) {}
+  RunLengthCube(int x, int y, int z) : x_(x), y_(y), z_(z) {}
+  explicit RunLengthCube(const BinaryCube &cube);
+  // visits non-empty bricks only
+  explicit RunLengthCube(const BrickedCube &cube);
+  RunLengthCube(const RunLengthCube &other)
+      : row_begin_(other.row_begin_),
+        x_(other.x_), y_(other.y_), z_(other.z_), runs_(other.runs_) {}
+  RunLengthCube(BOOST_RV_REF(RunLengthCube) other)
+      : x_(0), y_(0), z_(0) {
+    Swap(other);
+  }
+  RunLengthCube &operator=(BOOST_COPY_ASSIGN_REF(RunLengthCube) other) {
+    if (this != &other) {
+      row_begin_ = other.row_begin_;
+      x_ = other.x_;
+      y_ = other.y_;
+      z_ = other.z_;
+      runs_ = other.runs_;
+    }
+    return *this;
+  }
+  RunLengthCube &operator=(BOOST_RV_REF(RunLengthCube) other) {
+    if (this != &other) {
+      Clear();
+      Swap(other);
+    }
+    return *this;
+  }
+  void Swap(RunLengthCube &other);
+
+  int NumRows() const { return y_ * z_; }
+  int NumRuns() const { return (int)runs_.size(); }
+  long long CountVoxels() const;
+  // runs of row (y, z) are runs_[RowBegin(y, z), RowEnd(y, z))
+  int RowBegin(const int y, const int z) const {
+    const int r = z * y_ + y;
+    return r < (int)row_begin_.size() ? row_begin_[r] : (int)runs_.size();
+  }
+  int RowEnd(const int y, const int z) const {
+    const int r = z * y_ + y + 1;
+    return r < (int)row_begin_.size() ? row_begin_[r] : (int)runs_.size();
+  }
+
+  // Rows must be appended in raster order, and runs of a row in ascending
+  // order of x. Adjacent runs must be separated by at least one background
+  // voxel.
+  void AppendRun(const int y, const int z, const int begin, const int end);
+  // append every run of a bit-packed row (see BinaryCube::Row)
+  void AppendRow(const int y, const int z, const uint64_t *bits);
+  // append every row of `slice` (a cube with z_ == 1) as slice z
+  void AppendSlice(const int z, const RunLengthCube &slice);
+
+  bool Get(const int x, const int y, const int z) const;
+  // true if any foreground voxel lies in [lo, hi] of row (y, z)
+  bool AnyInRange(const int y, const int z, const int lo, const int hi) const;
+  BinaryCube ToBinaryCube() const;
+  void Clear();
+};
+} // namespace sigen
@@ -0,0 +1,167 @@
+#include "sigen/common/threshold.h"
+#include <algorithm>
+#include <boost/math/special_functions/next.hpp>
+#include <limits>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+namespace sigen {
+static void fillRow(const int n, const bool value, uint64_t *dst) {
+  const int words = (n + 63) / 64;
+  std::fill(dst, dst + words, value ? ~(uint64_t)0 : 0);
+  if (value && n % 64 != 0)
+    dst[words - 1] = ((uint64_t)1 << (n % 64)) - 1;
+}
+
+// val > t <=> val > floor(t) for integer voxels, and thresholds beyond
+// the range of T select all or nothing
+static bool integerThreshold(const double thresh, const int max_value, const int n,
+                             uint64_t *dst, int *t) {
+  if (thresh < 0 || thresh >= max_value) {
+    fillRow(n, thresh < 0, dst);
+    return false;
+  }
+  *t = (int)std::floor(thresh);
+  return true;
+}
+
+template <class T>
+struct Greater {
+  T t_;
+  explicit Greater(const T t) : t_(t) {}
+  bool operator()(const T v) const { return v > t_; }
+};
+
+template <class T>
+struct GreaterEqual {
+  T t_;
+  explicit GreaterEqual(const T t) : t_(t) {}
+  bool operator()(const T v) const { return v >= t_; }
+};
+
+// packs src[i, n) word by word; i must be a multiple of 64
+template <class T, class Compare>
+static void packScalar(const T *src, int i, const int n, const Compare &cmp, uint64_t *dst) {
+  for (; i < n; i += 64) {
+    const int end = std::min(n, i + 64);
+    uint64_t w = 0;
+    for (int x = i; x < end; ++x) {
+      w |= (uint64_t)cmp(src[x]) << (x - i);
+    }
+    dst[i / 64] = w;
+  }
+}
+
+void PackGreater(const uint8_t *src, const int n, const double thresh, uint64_t *dst) {
+  int t;
+  if (!integerThreshold(thresh, 255, n, dst, &t))
+    return;
+  int i = 0;
+#ifdef __SSE2__
+  // SSE2 only compares signed bytes, so flip the sign bits of both sides
+  const __m128i bias = _mm_set1_epi8((char)0x80);
+  const __m128i vt = _mm_set1_epi8((char)(t ^ 0x80));
+  for (; i + 64 <= n; i += 64) {
+    uint64_t w = 0;
+    for (int k = 0; k < 4; ++k) {
+      const __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src + i + 16 * k)), bias);
+      const uint64_t m = (uint16_t)_mm_movemask_epi8(_mm_cmpgt_epi8(v, vt));
+      w |= m << (16 * k);
+    }
+    dst[i / 64] = w;
+  }
+#endif
+  packScalar(src, i, n, Greater<uint8_t>((uint8_t)t), dst);
+}
+
+void PackGreater(const uint16_t *src, const int n, const double thresh, uint64_t *dst) {
+  int t;
+  if (!integerThreshold(thresh, 65535, n, dst, &t))
+    return;
+  int i = 0;
+#ifdef __SSE2__
+  const __m128i bias = _mm_set1_epi16((short)0x8000);
+  const __m128i vt = _mm_set1_epi16((short)(t ^ 0x8000));
+  for (; i + 64 <= n; i += 64) {
+    uint64_t w = 0;
+    for (int k = 0; k < 4; ++k) {
+      const uint16_t *p = src + i + 16 * k;
+      const __m128i lo = _mm_cmpgt_epi16(_mm_xor_si128(_mm_loadu_si128((const __m128i *)p), bias), vt);
+      const __m128i hi = _mm_cmpgt_epi16(_mm_xor_si128(_mm_loadu_si128((const __m128i *)(p + 8)), bias), vt);
+      // lanes are 0 or -1, so packing keeps them
+      const uint64_t m = (uint16_t)_mm_movemask_epi8(_mm_packs_epi16(lo, hi));
+      w |= m << (16 * k);
+    }
+    dst[i / 64] = w;
+  }
+#endif
+  packScalar(src, i, n, Greater<uint16_t>((uint16_t)t), dst);
+}
+
+#ifdef __SSE2__
+// 16 lanes of 0 or -1 (as 4 x 4 floats) into 16 bits
+static inline uint64_t movemask16(const __m128 a, const __m128 b, const __m128 c, const __m128 d) {
+  const __m128i ab = _mm_packs_epi32(_mm_castps_si128(a), _mm_castps_si128(b));
+  const __m128i cd = _mm_packs_epi32(_mm_castps_si128(c), _mm_castps_si128(d));
+  return (uint16_t)_mm_movemask_epi8(_mm_packs_epi16(ab, cd));
+}
+#endif
+
+// (float)thresh rounds to the nearest float, which may lie on either side
+// of thresh. A float voxel v is compared with thresh exactly (as the scalar
+// paths compare it in double) by using the nearest float on the right side:
+// v > thresh <=> v > floatAtMost(thresh), v >= thresh <=> v >= floatAtLeast(thresh).
+static float floatAtMost(const double thresh) {
+  const float t = (float)thresh;
+  if (!(t > thresh))
+    return t;
+  return t == -std::numeric_limits<float>::max() ? -std::numeric_limits<float>::infinity()
+                                                 : boost::math::float_prior(t);
+}
+
+static float floatAtLeast(const double thresh) {
+  const float t = (float)thresh;
+  if (!(t < thresh))
+    return t;
+  return t == std::numeric_limits<float>::max() ? std::numeric_limits<float>::infinity()
+                                                : boost::math::float_next(t);
+}
+
+void PackGreater(const float *src, const int n, const double thresh, uint64_t *dst) {
+  const float t = floatAtMost(thresh);
+  int i = 0;
+#ifdef __SSE2__
+  const __m128 vt = _mm_set1_ps(t);
+  for (; i + 64 <= n; i += 64) {
+    uint64_t w = 0;
+    for (int k = 0; k < 4; ++k) {
+      const float *p = src + i + 16 * k;
+      w |= movemask16(_mm_cmpgt_ps(_mm_loadu_ps(p), vt), _mm_cmpgt_ps(_mm_loadu_ps(p + 4), vt),
+                      _mm_cmpgt_ps(_mm_loadu_ps(p + 8), vt), _mm_cmpgt_ps(_mm_loadu_ps(p + 12), vt))
+           << (16 * k);
+    }
+    dst[i / 64] = w;
+  }
+#endif
+  packScalar(src, i, n, Greater<float>(t), dst);
+}
+
+void PackGreaterEqual(const float *src, const int n, const double thresh, uint64_t *dst) {
+  const float t = floatAtLeast(thresh);
+  int i = 0;
+#ifdef __SSE2__
+  const __m128 vt = _mm_set1_ps(t);
+  for (; i + 64 <= n; i += 64) {
+    uint64_t w = 0;
+    for (int k = 0; k < 4; ++k) {
+      const float *p = src + i + 16 * k;
+      w |= movemask16(_mm_cmpge_ps(_mm_loadu_ps(p), vt), _mm_cmpge_ps(_mm_loadu_ps(p + 4), vt),
+                      _mm_cmpge_ps(_mm_loadu_ps(p + 8), vt), _mm_cmpge_ps(_mm_loadu_ps(p + 12), vt))
+           << (16 * k);
+    }
+    dst[i / 64] = w;
+  }
+#endif
+  packScalar(src, i, n, GreaterEqual<float>(t), dst);
+}
+} // namespace sigen
@@ -0,0 +1,23 @@
+#pragma once
+#include <cmath>
+#include <stdint.h>
+namespace sigen {
+// Packs (src[i] > thresh) for 0 <= i < n into bits, in the layout of
+// BinaryCube::Row: bit (i % 64) of dst[i / 64]. Bits beyond n are cleared.
+// Uses SSE2 when available.
+// Float voxels are compared with thresh exactly, as if in double, so the
+// result matches a scalar (src[i] > thresh).
+void PackGreater(const uint8_t *src, const int n, const double thresh, uint64_t *dst);
+void PackGreater(const uint16_t *src, const int n, const double thresh, uint64_t *dst);
+void PackGreater(const float *src, const int n, const double thresh, uint64_t *dst);
+
+// same as PackGreater, but packs (src[i] >= thresh)
+// (for integer voxels, val >= thresh <=> val > ceil(thresh) - 1)
+inline void PackGreaterEqual(const uint8_t *src, const int n, const double thresh, uint64_t *dst) {
+  PackGreater(src, n, std::ceil(thresh) - 1, dst);
+}
+inline void PackGreaterEqual(const uint16_t *src, const int n, const double thresh, uint64_t *dst) {
+  PackGreater(src, n, std::ceil(thresh) - 1, dst);
+}
+void PackGreaterEqual(const float *src, const int n, const double thresh, uint64_t *dst);
+} // namespace sigen
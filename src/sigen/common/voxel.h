@@ -1,26 +1,14 @@
 #pragma once
-#include <boost/shared_ptr.hpp>
-#include <boost/utility.hpp>
-#include <vector>
 namespace sigen {
-class Voxel;
-typedef boost::shared_ptr<Voxel> VoxelPtr;
-class Voxel : boost::noncopyable {
+// A foreground voxel. Its neighbors are not stored; they are looked up in a
+// VoxelGrid from the coordinates.
+class Voxel {
 public:
   int x_, y_, z_;
-  bool flag_; // any functions can use this variable
-  int label_; // any functions can use this variable
-  std::vector<Voxel *> adjacent_;
+  unsigned epoch_; // the last search that visited this voxel
+  int label_;      // any functions can use this variable
 
   Voxel(int x, int y, int z)
-      : x_(x), y_(y), z_(z), flag_(false), label_(-1) {}
-
-  void AddConection(Voxel *p) {
-    assert(std::find(adjacent_.begin(), adjacent_.end(), p) == adjacent_.end());
-    adjacent_.push_back(p);
-  }
-  void AddConection(VoxelPtr p) {
-    this->AddConection(p.get());
-  }
+      : x_(x), y_(y), z_(z), epoch_(0), label_(-1) {}
 };
 } // namespace sigen
@@ -0,0 +1,83 @@
+#include "sigen/common/voxel_grid.h"
+#include <algorithm>
+#include <cassert>
+namespace sigen {
+namespace {
+struct EndNotAfter {
+  bool operator()(const Run &run, const int x) const { return run.end_ <= x; }
+};
+} // namespace
+
+VoxelGrid::VoxelGrid(const RunLengthCube &cube)
+    : runs_(cube.runs_), x_(cube.x_), y_(cube.y_), z_(cube.z_) {
+  row_begin_.reserve(cube.NumRows() + 1);
+  for (int z = 0; z < z_; ++z) {
+    for (int y = 0; y < y_; ++y) {
+      row_begin_.push_back(cube.RowBegin(y, z));
+    }
+  }
+  row_begin_.push_back(runs_.size());
+  run_offset_.reserve(runs_.size() + 1);
+  run_offset_.push_back(0);
+  for (int i = 0; i < (int)runs_.size(); ++i) {
+    run_offset_.push_back(run_offset_.back() + runs_[i].size());
+  }
+}
+
+int VoxelGrid::firstRunEndingAfter(int y, int z, int x) const {
+  const int r = z * y_ + y;
+  return std::lower_bound(runs_.begin() + row_begin_[r], runs_.begin() + row_begin_[r + 1],
+                          x, EndNotAfter()) -
+         runs_.begin();
+}
+
+int VoxelGrid::Find(int x, int y, int z) const {
+  if (x < 0 || x >= x_ || y < 0 || y >= y_ || z < 0 || z >= z_)
+    return -1;
+  const int i = firstRunEndingAfter(y, z, x);
+  if (i == row_begin_[z * y_ + y + 1] || runs_[i].begin_ > x)
+    return -1;
+  return run_offset_[i] + x - runs_[i].begin_;
+}
+
+int VoxelGrid::Neighbors(int x, int y, int z, int *out) const {
+  // rows are scanned in raster order, and the neighbors are written to
+  // slot (dx + 1) * 9 + (dy + 1) * 3 + (dz + 1) to be listed in dx, dy, dz order
+  int slots[27];
+  std::fill(slots, slots + 27, -1);
+  for (int dz = -1; dz <= 1; ++dz) {
+    const int nz = z + dz;
+    if (nz < 0 || nz >= z_)
+      continue;
+    for (int dy = -1; dy <= 1; ++dy) {
+      const int ny = y + dy;
+      if (ny < 0 || ny >= y_)
+        continue;
+      // at most two runs overlap [x - 1, x + 1]
+      const int end = row_begin_[nz * y_ + ny + 1];
+      for (int i = firstRunEndingAfter(ny, nz, x - 1); i < end && runs_[i].begin_ <= x + 1; ++i) {
+        const int lo = std::max(runs_[i].begin_, x - 1);
+        const int hi = std::min(runs_[i].end_ - 1, x + 1);
+        for (int nx = lo; nx <= hi; ++nx) {
+          slots[(nx - x + 1) * 9 + (dy + 1) * 3 + (dz + 1)] = run_offset_[i] + nx - runs_[i].begin_;
+        }
+      }
+    }
+  }
+  slots[13] = -1; // (x, y, z) itself
+  int n = 0;
+  for (int i = 0; i < 27; ++i) {
+    if (slots[i] != -1)
+      out[n++] = slots[i];
+  }
+  assert(n <= 26);
+  return n;
+}
+
+void VoxelGrid::Clear() {
+  std::vector<Run>().swap(runs_);
+  std::vector<int>().swap(row_begin_);
+  std::vector<int>(1, 0).swap(run_offset_);
+  x_ = y_ = z_ = 0;
+}
+} // namespace sigen
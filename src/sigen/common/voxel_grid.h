@@ -0,0 +1,32 @@
+#pragma once
+#include "sigen/common/run_length_cube.h"
+#include <vector>
+namespace sigen {
+// Indexes the foreground voxels of a RunLengthCube in raster order
+// (x-fastest, then y, then z). Voxel x of run r has index
+// run_offset_[r] + x - runs_[r].begin_, so a voxel is found among the few
+// runs of its row, and neighbors are computed from coordinates instead of
+// being stored per voxel.
+class VoxelGrid {
+  std::vector<Run> runs_;
+  std::vector<int> row_begin_;  // runs of row r are [row_begin_[r], row_begin_[r + 1])
+  std::vector<int> run_offset_; // index of the first voxel of each run, and the total
+
+  // first run of row (y, z) that ends after x
+  int firstRunEndingAfter(int y, int z, int x) const;
+
+public:
+  int x_, y_, z_;
+  VoxelGrid() : run_offset_(1, 0), x_(0), y_(0), z_(0) {}
+  explicit VoxelGrid(const RunLengthCube &cube);
+
+  int NumVoxels() const { return run_offset_.back(); }
+  // index of voxel (x, y, z), or -1 if it is background
+  int Find(int x, int y, int z) const;
+  // Writes the indexes of the 26-neighbors of (x, y, z) to `out` (at least
+  // 26 elements), and returns their number. They are listed by dx, then dy,
+  // then dz: the seeds and level sets of Extractor depend on this order.
+  int Neighbors(int x, int y, int z, int *out) const;
+  void Clear();
+};
+} // namespace sigen
@@ -1,226 +1,513 @@
 #include "sigen/extractor/extractor.h"
 #include "sigen/common/point.h"
+#include "sigen/extractor/frontier_bfs.h"
+#include "sigen/extractor/labeling.h"
+#include "sigen/extractor/prefilter.h"
 #include <algorithm>
 #include <boost/foreach.hpp>
-#include <boost/make_shared.hpp>
 #include <cassert>
-#include <iterator>
-#include <map>
-#include <queue>
+#include <climits>
+#include <cmath>
 #include <utility>
 #include <vector>
 namespace sigen {
 
-static void clearFrame(BinaryCube &c) {
-  for (int i = 0; i < c.x_; ++i) {
-    for (int j = 0; j < c.y_; ++j) {
-      c[i][j][0] = false;
-      c[i][j][c.z_ - 1] = false;
+static void clearFrame(RunLengthCube &c) {
+  RunLengthCube cc(c.x_, c.y_, c.z_);
+  for (int z = 1; z < c.z_ - 1; ++z) {
+    for (int y = 1; y < c.y_ - 1; ++y) {
+      for (int i = c.RowBegin(y, z); i < c.RowEnd(y, z); ++i) {
+        const int begin = std::max(c.runs_[i].begin_, 1);
+        const int end = std::min(c.runs_[i].end_, c.x_ - 1);
+        if (begin < end)
+          cc.AppendRun(y, z, begin, end);
+      }
     }
   }
-  for (int j = 0; j < c.y_; ++j) {
-    for (int k = 0; k < c.z_; ++k) {
-      c[0][j][k] = false;
-      c[c.x_ - 1][j][k] = false;
+  c = boost::move(cc);
+}
+
+// Runs are maximal, so only single-voxel runs can be isolated, and their
+// neighbors can only be in the 8 adjacent rows.
+static void removeIsolatedPoints(RunLengthCube &c) {
+  RunLengthCube cc(c.x_, c.y_, c.z_);
+  for (int z = 0; z < c.z_; ++z) {
+    for (int y = 0; y < c.y_; ++y) {
+      for (int i = c.RowBegin(y, z); i < c.RowEnd(y, z); ++i) {
+        const Run &run = c.runs_[i];
+        bool any = run.size() > 1;
+        for (int dz = -1; dz <= 1 && !any; ++dz) {
+          for (int dy = -1; dy <= 1 && !any; ++dy) {
+            if (dy == 0 && dz == 0)
+              continue;
+            any = c.AnyInRange(y + dy, z + dz, run.begin_ - 1, run.begin_ + 1);
+          }
+        }
+        if (any)
+          cc.AppendRun(y, z, run.begin_, run.end_);
+      }
     }
   }
-  for (int k = 0; k < c.z_; ++k) {
-    for (int i = 0; i < c.x_; ++i) {
-      c[i][0][k] = false;
-      c[i][c.y_ - 1][k] = false;
+  c = boost::move(cc);
+}
+
+static void beforeFilter(RunLengthCube &c) {
+  clearFrame(c);
+  removeIsolatedPoints(c);
+}
+
+static void clearFrame(BrickedCube &c) {
+  for (int z = 0; z < c.z_; ++z) {
+    for (int y = 0; y < c.y_; ++y) {
+      if (z == 0 || z == c.z_ - 1 || y == 0 || y == c.y_ - 1) {
+        for (int x = 0; x < c.x_; ++x)
+          c.Set(x, y, z, false);
+      } else {
+        c.Set(0, y, z, false);
+        c.Set(c.x_ - 1, y, z, false);
+      }
     }
   }
 }
 
-static void removeIsolatedPoints(BinaryCube &c) {
-  BinaryCube cc = c;
-  for (int x = 1; x < c.x_ - 1; ++x) {
-    for (int y = 1; y < c.y_ - 1; ++y) {
-      for (int z = 1; z < c.z_ - 1; ++z) {
-        bool any = false;
-        for (int dx = -1; dx <= 1; ++dx) {
-          for (int dy = -1; dy <= 1; ++dy) {
-            for (int dz = -1; dz <= 1; ++dz) {
-              if (dx == 0 && dy == 0 && dz == 0)
-                continue;
-              if (cc[x + dx][y + dy][z + dz])
-                any = true;
+// bits of an 8x8 layer word at lx == 0 / lx == 7
+static const uint64_t kColumn0 = 0x0101010101010101ULL;
+static const uint64_t kColumn7 = 0x8080808080808080ULL;
+// bits of an 8x8 layer word at lx, ly in {0, 7}
+static const uint64_t kLayerBorder = 0xff818181818181ffULL;
+
+static uint64_t dilateX(const uint64_t w) {
+  return ((w << 1) & ~kColumn0) | ((w >> 1) & ~kColumn7);
+}
+
+// 3x3 dilation in a layer
+static uint64_t dilateXY(const uint64_t w) {
+  const uint64_t h = w | dilateX(w);
+  return h | (h << 8) | (h >> 8);
+}
+
+// Removing an isolated point never isolates another one, so this works in
+// place. Inside a brick, neighbors are found with word-wide shifts; only
+// voxels on the brick surface look into adjacent bricks.
+static void removeIsolatedPoints(BrickedCube &c) {
+  for (int bz = 0; bz < c.BricksZ(); ++bz) {
+    for (int by = 0; by < c.BricksY(); ++by) {
+      for (int bx = 0; bx < c.BricksX(); ++bx) {
+        const int index = c.BrickIndex(bx, by, bz);
+        if (c.IsEmpty(index))
+          continue;
+        uint64_t w[8];
+        std::copy(c.Brick(index), c.Brick(index) + 8, w);
+        for (int lz = 0; lz < 8; ++lz) {
+          if (w[lz] == 0)
+            continue;
+          const uint64_t h = w[lz] | dilateX(w[lz]);
+          uint64_t neighbor = dilateX(w[lz]) | (h << 8) | (h >> 8);
+          if (lz > 0)
+            neighbor |= dilateXY(w[lz - 1]);
+          if (lz < 7)
+            neighbor |= dilateXY(w[lz + 1]);
+          uint64_t lonely = w[lz] & ~neighbor;
+          for (; lonely != 0; lonely &= lonely - 1) {
+            const int bit = CountTrailingZeros(lonely);
+            const int x = bx * 8 + (bit & 7);
+            const int y = by * 8 + (bit >> 3);
+            const int z = bz * 8 + lz;
+            bool any = false;
+            if ((kLayerBorder >> bit) & 1 || lz == 0 || lz == 7) {
+              for (int dz = -1; dz <= 1 && !any; ++dz) {
+                for (int dy = -1; dy <= 1 && !any; ++dy) {
+                  for (int dx = -1; dx <= 1 && !any; ++dx) {
+                    if (dx == 0 && dy == 0 && dz == 0)
+                      continue;
+                    any = c.GetOrFalse(x + dx, y + dy, z + dz);
+                  }
+                }
+              }
+            }
+            if (!any) {
+              c.Set(x, y, z, false);
             }
           }
         }
-        if (!any) {
-          c[x][y][z] = false;
-        }
       }
     }
   }
 }
 
-static void beforeFilter(BinaryCube &c) {
+static void beforeFilter(BrickedCube &c) {
   clearFrame(c);
   removeIsolatedPoints(c);
 }
 
-static void setLabel(Voxel *p, const int label) {
-  p->flag_ = true;
-  p->label_ = label;
-  BOOST_FOREACH (Voxel *next, p->adjacent_) {
-    if (next->flag_ == false) {
-      setLabel(next, label);
-    }
-  }
-}
-
+// descending order of size; stable sorting keeps ties in order of their first voxel
 template <class T>
-class compareSize {
+class largerSize {
 public:
   bool operator()(const T &lhs, const T &rhs) const {
-    return lhs.size() < rhs.size();
+    return lhs.size() > rhs.size();
   }
 };
 
-// This functions is HOT SPOT.
-// This is worth to tune.
-void Extractor::Labeling() {
-  beforeFilter(cube_);
-  std::map<IPoint, VoxelPtr> voxels;
-  for (int x = 1; x < cube_.x_ - 1; ++x) {
-    for (int y = 1; y < cube_.y_ - 1; ++y) {
-      for (int z = 1; z < cube_.z_ - 1; ++z) {
-        if (cube_[x][y][z]) {
-          voxels[IPoint(x, y, z)] = boost::make_shared<Voxel>(x, y, z);
+// Stable counting sort of voxel indexes `order` by the coordinate `key`
+// (in [0, range)).
+static void sortByCoordinate(const std::vector<Voxel> &voxels, int Voxel::*key,
+                             const int range, std::vector<int> &order) {
+  std::vector<int> begin(range + 1, 0);
+  for (size_t i = 0; i < order.size(); ++i) {
+    ++begin[voxels[order[i]].*key + 1];
+  }
+  for (int k = 0; k < range; ++k) {
+    begin[k + 1] += begin[k];
+  }
+  std::vector<int> sorted(order.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    sorted[begin[voxels[order[i]].*key]++] = order[i];
+  }
+  order.swap(sorted);
+}
+
+// Drops the runs of components of fewer than `min_voxels` voxels, and
+// renumbers the others in the same order. Returns the number of components.
+static int dropSmallComponents(RunLengthCube &runs, std::vector<int> &labels,
+                               const int num_labels, const int min_voxels) {
+  std::vector<long long> sizes(num_labels, 0);
+  for (int i = 0; i < (int)runs.runs_.size(); ++i) {
+    sizes[labels[i]] += runs.runs_[i].size();
+  }
+  std::vector<int> renumber(num_labels, -1);
+  int num_kept = 0;
+  for (int i = 0; i < num_labels; ++i) {
+    if (sizes[i] >= min_voxels)
+      renumber[i] = num_kept++;
+  }
+  if (num_kept == num_labels)
+    return num_labels;
+  RunLengthCube kept(runs.x_, runs.y_, runs.z_);
+  std::vector<int> kept_labels;
+  for (int z = 0; z < runs.z_; ++z) {
+    for (int y = 0; y < runs.y_; ++y) {
+      for (int i = runs.RowBegin(y, z); i < runs.RowEnd(y, z); ++i) {
+        if (renumber[labels[i]] != -1) {
+          kept.AppendRun(y, z, runs.runs_[i].begin_, runs.runs_[i].end_);
+          kept_labels.push_back(renumber[labels[i]]);
         }
       }
     }
   }
-  typedef std::pair<IPoint, VoxelPtr> iter_type;
-  BOOST_FOREACH (iter_type p, voxels) {
-    // enumerate 26 neighbors
-    for (int dx = -1; dx <= 1; ++dx) {
-      for (int dy = -1; dy <= 1; ++dy) {
-        for (int dz = -1; dz <= 1; ++dz) {
-          if (dx == 0 && dy == 0 && dz == 0)
-            continue;
-          int x = p.first.x_ + dx;
-          int y = p.first.y_ + dy;
-          int z = p.first.z_ + dz;
-          IPoint t(x, y, z);
-          if (voxels.count(t)) {
-            p.second->AddConection(voxels[t]);
-          }
+  runs = boost::move(kept);
+  labels.swap(kept_labels);
+  return num_kept;
+}
+
+void Extractor::init() {
+  filtered_ = false;
+  frontier_bfs_min_voxels_ = kFrontierBfsMinVoxels;
+  summarize_ = false;
+  scale_xy_ = 1.0;
+  scale_z_ = 1.0;
+  min_component_voxels_ = 0;
+}
+
+// The cost of this function scales with the number of foreground voxels
+// (except for filtering a dense `cube_` and the brick summary of `bricks_`).
+// This functions is HOT SPOT.
+// This is worth to tune.
+void Extractor::Labeling() {
+  if (cube_.IsMapped()) {
+    // read the file once, and keep it out of anonymous memory
+    runs_ = RunLengthCube(cube_);
+    cube_.Clear();
+    if (!filtered_)
+      beforeFilter(runs_);
+  } else if (cube_.x_ > 0) {
+    // dense input: filter words in place, then encode and release the cube
+    if (!filtered_)
+      Prefilter(cube_);
+    runs_ = RunLengthCube(cube_);
+    cube_.Clear();
+  } else if (bricks_.x_ > 0) {
+    // bricked input: empty bricks are skipped while filtering and encoding
+    if (!filtered_)
+      beforeFilter(bricks_);
+    runs_ = RunLengthCube(bricks_);
+    bricks_.Clear();
+  } else if (!filtered_) {
+    beforeFilter(runs_);
+  }
+  std::vector<int> run_labels;
+  int num_labels = LabelRuns(runs_, run_labels);
+  if (min_component_voxels_ > 1)
+    num_labels = dropSmallComponents(runs_, run_labels, num_labels, min_component_voxels_);
+  // voxel indexes follow the runs, so no search is needed to enumerate them
+  grid_ = VoxelGrid(runs_);
+  voxels_.clear();
+  voxels_.reserve(grid_.NumVoxels());
+  std::vector<int> sizes(num_labels, 0);
+  for (int z = 0; z < runs_.z_; ++z) {
+    for (int y = 0; y < runs_.y_; ++y) {
+      for (int i = runs_.RowBegin(y, z); i < runs_.RowEnd(y, z); ++i) {
+        for (int x = runs_.runs_[i].begin_; x < runs_.runs_[i].end_; ++x) {
+          voxels_.push_back(Voxel(x, y, z));
+          voxels_.back().label_ = run_labels[i];
         }
+        sizes[run_labels[i]] += runs_.runs_[i].size();
       }
     }
   }
-  // reset flags
-  BOOST_FOREACH (iter_type p, voxels)
-    p.second->flag_ = false;
-  // set flags
-  int label = 0;
-  BOOST_FOREACH (iter_type p, voxels) {
-    if (p.second->flag_ == false) {
-      setLabel(p.second.get(), label++);
-    }
+  const int size_x = runs_.x_, size_y = runs_.y_;
+  runs_.Clear();
+  // Components list their voxels in (x, y, z) order and are numbered by
+  // their first voxel, as when the voxels were kept in a std::map<IPoint>:
+  // the seeds and level sets depend on it. The raster order is sorted by z,
+  // so stable passes by y and then by x give it.
+  std::vector<int> order(voxels_.size());
+  for (int i = 0; i < (int)order.size(); ++i) {
+    order[i] = i;
+  }
+  sortByCoordinate(voxels_, &Voxel::y_, size_y, order);
+  sortByCoordinate(voxels_, &Voxel::x_, size_x, order);
+  std::vector<int> component(num_labels, -1);
+  int num_components = 0;
+  for (size_t i = 0; i < order.size(); ++i) {
+    int &c = component[voxels_[order[i]].label_];
+    if (c == -1)
+      c = num_components++;
   }
-  components_.assign(label, std::vector<VoxelPtr>());
-  BOOST_FOREACH (iter_type p, voxels) {
-    components_[p.second->label_].push_back(p.second);
+  components_.assign(num_labels, std::vector<int>());
+  for (int i = 0; i < num_labels; ++i) {
+    components_[component[i]].reserve(sizes[i]);
   }
-  std::sort(components_.begin(), components_.end(), compareSize<std::vector<VoxelPtr> >());
-  std::reverse(components_.begin(), components_.end());
+  for (size_t i = 0; i < order.size(); ++i) {
+    components_[component[voxels_[order[i]].label_]].push_back(order[i]);
+  }
+  std::stable_sort(components_.begin(), components_.end(), largerSize<std::vector<int> >());
 }
 
-static void resetFlag(std::vector<VoxelPtr> &voxels) {
-  BOOST_FOREACH (VoxelPtr p, voxels)
-    p->flag_ = false;
-}
+// Breadth-first search over the voxels of one component at a time.
+// Every search stamps the voxels it visits with a new epoch instead of
+// resetting flags, and the queue buffer is reused across searches, so a
+// search costs the voxels it visits and nothing more.
+// Components share no voxels, so each thread can run its own engine.
+class VoxelBfs {
+  const VoxelGrid &grid_;
+  std::vector<Voxel> &voxels_;
+  std::vector<int> queue_;
+  unsigned epoch_;
 
-static Voxel *findSingleSeed(std::vector<VoxelPtr> &group) {
-  assert(!group.empty());
-  Voxel *last = group[0].get();
-  for (int i = 0; i < 2; ++i) {
-    resetFlag(group);
-    last->flag_ = true;
-    std::queue<Voxel *> que;
-    que.push(last);
-    while (!que.empty()) {
-      last = que.front();
-      que.pop();
-      BOOST_FOREACH (Voxel *next, last->adjacent_) {
-        if (!next->flag_) {
-          next->flag_ = true;
-          que.push(next);
+  void visit(const int index) {
+    voxels_[index].epoch_ = epoch_;
+    queue_.push_back(index);
+  }
+
+public:
+  VoxelBfs(const VoxelGrid &grid, std::vector<Voxel> &voxels)
+      : grid_(grid), voxels_(voxels), epoch_(0) {}
+  // Visits the component of `start`, and returns the last voxel visited
+  // (one of the farthest from `start`). If `record_distance`, label_ of
+  // every voxel becomes its distance from `start`.
+  int Search(const int start, const bool record_distance) {
+    ++epoch_;
+    queue_.clear();
+    visit(start);
+    if (record_distance)
+      voxels_[start].label_ = 0;
+    int adjacent[26];
+    for (size_t head = 0; head < queue_.size(); ++head) {
+      const Voxel &p = voxels_[queue_[head]];
+      const int n = grid_.Neighbors(p.x_, p.y_, p.z_, adjacent);
+      for (int j = 0; j < n; ++j) {
+        Voxel &next = voxels_[adjacent[j]];
+        if (next.epoch_ != epoch_) {
+          if (record_distance)
+            next.label_ = p.label_ + 1;
+          visit(adjacent[j]);
         }
       }
     }
+    return queue_.back();
   }
-  return last;
-}
-
-static void setDistance(std::vector<VoxelPtr> &group, Voxel *seed) {
-  resetFlag(group);
-  std::queue<Voxel *> que;
-  seed->flag_ = true;
-  seed->label_ = 0;
-  que.push(seed);
-  while (!que.empty()) {
-    Voxel *p = que.front();
-    que.pop();
-    BOOST_FOREACH (Voxel *next, p->adjacent_) {
-      if (!next->flag_) {
-        next->flag_ = true;
-        next->label_ = p->label_ + 1;
-        que.push(next);
+  // starts a new epoch for ExtractSameDistance
+  void BeginLevelSets() { ++epoch_; }
+  bool IsVisited(const int index) const { return voxels_[index].epoch_ == epoch_; }
+  // Appends the voxels of the same distance as `seed`, connected to it
+  // through them, to `out` as cluster `cluster`. label_ of a voxel becomes
+  // its cluster, and the clusters extracted before that touch this one are
+  // appended to `adjacent`.
+  void ExtractSameDistance(const int seed, const int cluster, std::vector<IPoint> &out, std::vector<int> &adjacent_clusters) {
+    queue_.clear();
+    const int label = voxels_[seed].label_;
+    visit(seed);
+    voxels_[seed].label_ = cluster;
+    int adjacent[26];
+    for (size_t head = 0; head < queue_.size(); ++head) {
+      const Voxel &p = voxels_[queue_[head]];
+      out.push_back(IPoint(p.x_, p.y_, p.z_));
+      const int n = grid_.Neighbors(p.x_, p.y_, p.z_, adjacent);
+      for (int j = 0; j < n; ++j) {
+        Voxel &next = voxels_[adjacent[j]];
+        if (next.epoch_ != epoch_) {
+          if (next.label_ == label) {
+            visit(adjacent[j]);
+            next.label_ = cluster;
+          }
+        } else if (next.label_ != cluster) {
+          adjacent_clusters.push_back(next.label_);
+        }
       }
     }
   }
-}
+};
 
-static std::vector<Voxel *> extractSameDistance(Voxel *seed) {
-  std::vector<Voxel *> ret;
-  std::queue<Voxel *> que;
-  seed->flag_ = true;
-  ret.push_back(seed);
-  que.push(seed);
-  while (!que.empty()) {
-    Voxel *p = que.front();
-    que.pop();
-    BOOST_FOREACH (Voxel *next, p->adjacent_) {
-      if (!next->flag_ && next->label_ == seed->label_) {
-        next->flag_ = true;
-        ret.push_back(next);
-        que.push(next);
+// same as VoxelBfs::Search(seed, true), a whole level at a time (see FrontierBfs)
+static void setDistanceBitwise(const VoxelGrid &grid, std::vector<Voxel> &voxels,
+                               const std::vector<int> &group, const int seed) {
+  FrontierBfs bfs(voxels, group);
+  bfs.Start(voxels[seed].x_, voxels[seed].y_, voxels[seed].z_);
+  const BinaryCube &frontier = bfs.Frontier();
+  int distance = 0;
+  do {
+    for (int z = bfs.ZBegin(); z < bfs.ZEnd(); ++z) {
+      for (int y = 0; y < frontier.y_; ++y) {
+        const uint64_t *row = frontier.Row(y, z);
+        for (int i = 0; i < frontier.WordsPerRow(); ++i) {
+          for (uint64_t w = row[i]; w != 0; w &= w - 1) {
+            const int x = i * 64 + CountTrailingZeros(w);
+            const int index = grid.Find(x + bfs.x0_, y + bfs.y0_, z + bfs.z0_);
+            assert(index != -1);
+            voxels[index].label_ = distance;
+          }
+        }
       }
     }
+    ++distance;
+  } while (bfs.Next());
+}
+
+static bool isWideComponent(const std::vector<Voxel> &voxels, const std::vector<int> &group, const int min_voxels) {
+  if (min_voxels <= 0 || (int)group.size() < min_voxels)
+    return false;
+  int x0 = INT_MAX, y0 = INT_MAX, z0 = INT_MAX, x1 = INT_MIN, y1 = INT_MIN, z1 = INT_MIN;
+  BOOST_FOREACH (int i, group) {
+    const Voxel &v = voxels[i];
+    x0 = std::min(x0, v.x_), y0 = std::min(y0, v.y_), z0 = std::min(z0, v.z_);
+    x1 = std::max(x1, v.x_), y1 = std::max(y1, v.y_), z1 = std::max(z1, v.z_);
   }
-  return ret;
+  const double volume = (double)(x1 - x0 + 1) * (y1 - y0 + 1) * (z1 - z0 + 1);
+  return volume <= 8.0 * group.size();
 }
 
-static std::vector<IPoint> voxelsToPoints(const std::vector<Voxel *> &vs) {
-  std::vector<IPoint> ps;
-  BOOST_FOREACH (Voxel *v, vs) {
-    ps.push_back(IPoint(v->x_, v->y_, v->z_));
+// Builder::ComputeGravityPoints and Builder::ComputeRadius of one cluster,
+// whose points are only in the transient `points`: running sums give the
+// gravity point, and a second pass over `points` the radius.
+static void addSummary(const std::vector<IPoint> &points, const double scale_xy, const double scale_z,
+                       ClusterStore &out) {
+  assert(!points.empty());
+  double sx = 0.0, sy = 0.0, sz = 0.0;
+  BOOST_FOREACH (const IPoint &p, points) {
+    sx += p.x_;
+    sy += p.y_;
+    sz += p.z_;
   }
-  return ps;
+  const double gx = sx / points.size(), gy = sy / points.size(), gz = sz / points.size();
+  double mx = 0.0;
+  BOOST_FOREACH (const IPoint &p, points) {
+    double dx = scale_xy * (p.x_ - gx);
+    double dy = scale_xy * (p.y_ - gy);
+    double dz = scale_z * (p.z_ - gz);
+    mx = std::max(mx, std::sqrt(dx * dx + dy * dy + dz * dz));
+  }
+  out.AddSummary(gx, gy, gz, mx);
 }
 
-std::vector<ClusterPtr> Extractor::Extract() {
-  Labeling();
-  std::vector<ClusterPtr> ret;
-  // NOT const
-  BOOST_FOREACH (std::vector<VoxelPtr> &group, components_) {
-    Voxel *seed = findSingleSeed(group);
-    setDistance(group, seed);
-    resetFlag(group);
-    BOOST_FOREACH (VoxelPtr p, group) {
-      if (p->flag_ == false) {
-        std::vector<Voxel *> vs = extractSameDistance(p.get());
-        std::vector<IPoint> ps = voxelsToPoints(vs);
-        assert(!ps.empty());
-        ret.push_back(boost::make_shared<Cluster>(ps));
+// Appends the clusters of one component to `out`, in the order of its voxels,
+// and their adjacency: voxels of a cluster only touch voxels of distance
+// d - 1, d and d + 1, which are seen while the cluster is collected.
+// The seed is found by a double sweep: the voxel last reached from the first
+// voxel, then the voxel last reached from it. A third search from the seed
+// records the geodesic distance.
+static void extractComponent(Extractor &ext, const std::vector<int> &group, VoxelBfs &bfs,
+                             ClusterStore &out) {
+  assert(!group.empty());
+  const int seed = bfs.Search(bfs.Search(group[0], false), false);
+  if (isWideComponent(ext.voxels_, group, ext.frontier_bfs_min_voxels_))
+    setDistanceBitwise(ext.grid_, ext.voxels_, group, seed);
+  else
+    bfs.Search(seed, true);
+  bfs.BeginLevelSets();
+  if (!ext.summarize_)
+    out.points_.reserve(group.size());
+  std::vector<IPoint> points;
+  std::vector<int> adjacent;
+  BOOST_FOREACH (int i, group) {
+    if (!bfs.IsVisited(i)) {
+      const int cluster = out.size();
+      adjacent.clear();
+      if (ext.summarize_) {
+        points.clear();
+        bfs.ExtractSameDistance(i, cluster, points, adjacent);
+        addSummary(points, ext.scale_xy_, ext.scale_z_, out);
+      } else {
+        bfs.ExtractSameDistance(i, cluster, out.points_, adjacent);
+        out.CloseCluster();
       }
+      std::sort(adjacent.begin(), adjacent.end());
+      adjacent.erase(std::unique(adjacent.begin(), adjacent.end()), adjacent.end());
+      BOOST_FOREACH (int j, adjacent) {
+        out.edges_.push_back(std::make_pair(j, cluster));
+      }
+    }
+  }
+  std::sort(out.edges_.begin(), out.edges_.end());
+}
+
+// Components share no voxels, so they are extracted in parallel.
+// Dynamic scheduling hands out the largest components first and lets idle
+// threads take the rest. Each component has its own output, concatenated in
+// the order of components_, so the result does not depend on threads.
+ClusterStore Extractor::Extract() {
+  Labeling();
+  const int n = components_.size();
+  std::vector<ClusterStore> outputs(n);
+#pragma omp parallel
+  {
+    VoxelBfs bfs(grid_, voxels_);
+#pragma omp for schedule(dynamic, 1)
+    for (int i = 0; i < n; ++i) {
+      extractComponent(*this, components_[i], bfs, outputs[i]);
+    }
+  }
+  size_t num_points = 0, num_clusters = 0, num_edges = 0;
+  for (int i = 0; i < n; ++i) {
+    num_points += outputs[i].points_.size();
+    num_clusters += outputs[i].size();
+    num_edges += outputs[i].edges_.size();
+  }
+  ClusterStore ret;
+  ret.points_.reserve(num_points);
+  ret.offsets_.reserve(num_clusters + 1);
+  ret.edges_.reserve(num_edges);
+  if (summarize_) {
+    ret.gx_.reserve(num_clusters);
+    ret.gy_.reserve(num_clusters);
+    ret.gz_.reserve(num_clusters);
+    ret.radius_.reserve(num_clusters);
+  }
+  std::vector<int> bases(n);
+  for (int i = 0; i < n; ++i) {
+    bases[i] = ret.size();
+    ret.Append(outputs[i]);
+    outputs[i].Clear();
+  }
+  // label_ of a voxel was its cluster in the output of its component
+#pragma omp parallel for schedule(dynamic, 1)
+  for (int i = 0; i < n; ++i) {
+    BOOST_FOREACH (int v, components_[i]) {
+      voxels_[v].label_ += bases[i];
     }
   }
+  ret.has_summary_ = summarize_;
+  ret.has_edges_ = true;
   return ret;
 }
 } // namespace sigen
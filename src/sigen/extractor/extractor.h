@@ -1,17 +1,54 @@
 #pragma once
 #include "sigen/common/binary_cube.h"
-#include "sigen/common/cluster.h"
+#include "sigen/common/bricked_cube.h"
+#include "sigen/common/cluster_store.h"
+#include "sigen/common/run_length_cube.h"
 #include "sigen/common/voxel.h"
+#include "sigen/common/voxel_grid.h"
 #include <boost/utility.hpp>
 #include <vector>
 namespace sigen {
 class Extractor : boost::noncopyable {
+  // sets the options (filtered_ to min_component_voxels_) to their defaults
+  void init();
   void Labeling();
 
 public:
+  static const int kFrontierBfsMinVoxels = 1 << 16;
+  // Labeling() consumes `cube_` (dense input), `bricks_` or `runs_`.
+  // A memory-mapped `cube_` is only read (see BinaryCube::OpenMapped).
   BinaryCube cube_;
-  std::vector<std::vector<VoxelPtr> > components_;
-  explicit Extractor(const BinaryCube &cube) : cube_(cube) {}
-  std::vector<ClusterPtr> Extract();
+  // Set if the input is already filtered (e.g. by PrefilterSlice during
+  // binarization), so Labeling() does not filter it again.
+  bool filtered_;
+  // Components of at least this many voxels, filling at least 1/8 of their
+  // bounding box, get their geodesic distance from FrontierBfs (0: never).
+  int frontier_bfs_min_voxels_;
+  // If set, Extract() keeps no points: each cluster gets its gravity point
+  // and radius (scaled by scale_xy_ and scale_z_, as Builder computes them)
+  // while it is extracted, and Builder skips those passes.
+  bool summarize_;
+  double scale_xy_, scale_z_;
+  // Components of fewer voxels (after filtering) are dropped right after
+  // labeling, before any per-component work (0: keep every component).
+  int min_component_voxels_;
+  BrickedCube bricks_;
+  RunLengthCube runs_;
+  // foreground voxels in raster order, indexed by `grid_`; after Extract(),
+  // label_ of a voxel is the index of its cluster
+  VoxelGrid grid_;
+  std::vector<Voxel> voxels_;
+  // indexes of voxels_ in (x, y, z) order, in descending order of size
+  std::vector<std::vector<int> > components_;
+  explicit Extractor(const BinaryCube &cube) : cube_(cube), bricks_(0, 0, 0) { init(); }
+  // takes over the buffer of `cube`, e.g. Extractor ext(boost::move(cube))
+  explicit Extractor(BOOST_RV_REF(BinaryCube) cube) : cube_(boost::move(cube)), bricks_(0, 0, 0) { init(); }
+  explicit Extractor(const BrickedCube &bricks) : cube_(0, 0, 0), bricks_(bricks) { init(); }
+  explicit Extractor(BOOST_RV_REF(BrickedCube) bricks)
+      : cube_(0, 0, 0), bricks_(boost::move(bricks)) { init(); }
+  explicit Extractor(const RunLengthCube &runs) : cube_(0, 0, 0), bricks_(0, 0, 0), runs_(runs) { init(); }
+  explicit Extractor(BOOST_RV_REF(RunLengthCube) runs)
+      : cube_(0, 0, 0), bricks_(0, 0, 0), runs_(boost::move(runs)) { init(); }
+  ClusterStore Extract();
 };
 } // namespace sigen
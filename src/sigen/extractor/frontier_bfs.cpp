@@ -0,0 +1,89 @@
+#include "sigen/extractor/frontier_bfs.h"
+#include <algorithm>
+#include <boost/foreach.hpp>
+#include <climits>
+namespace sigen {
+// 3-wide dilation along x of word i of a row
+static uint64_t dilateX(const uint64_t *row, const int i, const int words) {
+  const uint64_t w = row[i];
+  uint64_t d = w | (w << 1) | (w >> 1);
+  if (i > 0)
+    d |= row[i - 1] >> 63;
+  if (i + 1 < words)
+    d |= row[i + 1] << 63;
+  return d;
+}
+
+static BinaryCube boundingCube(const std::vector<Voxel> &voxels, const std::vector<int> &group,
+                               int &x0, int &y0, int &z0) {
+  int x1 = INT_MIN, y1 = INT_MIN, z1 = INT_MIN;
+  x0 = y0 = z0 = INT_MAX;
+  BOOST_FOREACH (int i, group) {
+    const Voxel &v = voxels[i];
+    x0 = std::min(x0, v.x_), y0 = std::min(y0, v.y_), z0 = std::min(z0, v.z_);
+    x1 = std::max(x1, v.x_), y1 = std::max(y1, v.y_), z1 = std::max(z1, v.z_);
+  }
+  // the margin keeps the neighbors of every voxel inside the cube
+  --x0, --y0, --z0;
+  return BinaryCube(x1 - x0 + 2, y1 - y0 + 2, z1 - z0 + 2);
+}
+
+FrontierBfs::FrontierBfs(const std::vector<Voxel> &voxels, const std::vector<int> &group)
+    : unvisited_(boundingCube(voxels, group, x0_, y0_, z0_)),
+      frontier_(unvisited_.x_, unvisited_.y_, unvisited_.z_),
+      next_(unvisited_.x_, unvisited_.y_, unvisited_.z_),
+      z_begin_(0), z_end_(0) {
+  BOOST_FOREACH (int i, group) {
+    const Voxel &v = voxels[i];
+    unvisited_.Set(v.x_ - x0_, v.y_ - y0_, v.z_ - z0_, true);
+  }
+}
+
+void FrontierBfs::Start(int x, int y, int z) {
+  x -= x0_, y -= y0_, z -= z0_;
+  frontier_.Set(x, y, z, true);
+  unvisited_.Set(x, y, z, false);
+  z_begin_ = z;
+  z_end_ = z + 1;
+}
+
+bool FrontierBfs::Next() {
+  const int words = frontier_.WordsPerRow();
+  // the margin slices never hold voxels
+  const int z_begin = std::max(1, z_begin_ - 1), z_end = std::min(frontier_.z_ - 1, z_end_ + 1);
+  int new_begin = z_end, new_end = z_begin;
+  for (int z = z_begin; z < z_end; ++z) {
+    bool any = false;
+    for (int y = 1; y < frontier_.y_ - 1; ++y) {
+      uint64_t *out = next_.Row(y, z);
+      uint64_t *unvisited = unvisited_.Row(y, z);
+      for (int i = 0; i < words; ++i) {
+        uint64_t w = 0;
+        if (unvisited[i] != 0) {
+          for (int dz = -1; dz <= 1; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+              w |= dilateX(frontier_.Row(y + dy, z + dz), i, words);
+            }
+          }
+          w &= unvisited[i];
+          unvisited[i] &= ~w;
+        }
+        out[i] = w;
+        any |= w != 0;
+      }
+    }
+    if (any) {
+      new_begin = std::min(new_begin, z);
+      new_end = z + 1;
+    }
+  }
+  frontier_.Swap(next_);
+  // next_ is now the previous level; clear it for the next call
+  for (int z = z_begin_; z < z_end_; ++z) {
+    std::fill(next_.Row(0, z), next_.Row(0, z) + (size_t)words * next_.y_, 0);
+  }
+  z_begin_ = new_begin;
+  z_end_ = std::max(new_begin, new_end);
+  return z_begin_ < z_end_;
+}
+} // namespace sigen
@@ -0,0 +1,36 @@
+#pragma once
+#include "sigen/common/binary_cube.h"
+#include "sigen/common/voxel.h"
+#include <boost/utility.hpp>
+#include <vector>
+namespace sigen {
+// Breadth-first search of one component a whole level at a time.
+// The component is copied into a bit-packed cube of its bounding box, and
+// each level is computed with word-wide operations:
+//   next = dilate(frontier) & unvisited, unvisited &= ~next
+// so the level sets of the geodesic distance come out as bitmasks. This
+// pays off for large, dense components whose frontier is wide; a thin
+// neurite is better served by a voxel queue.
+class FrontierBfs : boost::noncopyable {
+public:
+  // origin of the bounding box (including a margin of one voxel); declared
+  // before the cubes, whose initializer computes it
+  int x0_, y0_, z0_;
+
+private:
+  BinaryCube unvisited_, frontier_, next_;
+  int z_begin_, z_end_; // slices of the bounding box where the frontier may be
+
+public:
+  FrontierBfs(const std::vector<Voxel> &voxels, const std::vector<int> &group);
+  // the frontier becomes the voxel (x, y, z) of the component (call once)
+  void Start(int x, int y, int z);
+  // Advances the frontier to the next level. Returns false if it is empty.
+  bool Next();
+  // the current level set, in coordinates relative to (x0_, y0_, z0_)
+  const BinaryCube &Frontier() const { return frontier_; }
+  // only slices [ZBegin(), ZEnd()) of Frontier() may be non-empty
+  int ZBegin() const { return z_begin_; }
+  int ZEnd() const { return z_end_; }
+};
+} // namespace sigen
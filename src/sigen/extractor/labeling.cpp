@@ -0,0 +1,79 @@
+#include "sigen/extractor/labeling.h"
+#include "sigen/common/disjoint_set.h"
+#include "sigen/common/parallel.h"
+#include <algorithm>
+#include <cassert>
+namespace sigen {
+// merges the runs of row `i` with the runs of row `j` they touch
+static void mergeRows(const RunLengthCube &cube, DisjointSetInternal &uf,
+                      int i, const int i_end, int j, const int j_end) {
+  const std::vector<Run> &runs = cube.runs_;
+  while (i < i_end && j < j_end) {
+    // diagonal neighbors: [begin_ - 1, end_] of one run touches the other
+    if (runs[j].end_ >= runs[i].begin_ && runs[j].begin_ <= runs[i].end_)
+      uf.Merge(i, j);
+    // the run ending first cannot touch later runs of the other row
+    if (runs[i].end_ < runs[j].end_)
+      ++i;
+    else
+      ++j;
+  }
+}
+
+// Merges the runs of row (y, z) with the preceding rows in raster order:
+// (y - 1, z), and (y - 1 .. y + 1, z - 1) if `previous_slice`.
+static void mergeRow(const RunLengthCube &cube, DisjointSetInternal &uf,
+                     const int y, const int z, const bool same_slice, const bool previous_slice) {
+  const int begin = cube.RowBegin(y, z), end = cube.RowEnd(y, z);
+  if (begin == end)
+    return;
+  if (same_slice && y > 0)
+    mergeRows(cube, uf, begin, end, cube.RowBegin(y - 1, z), cube.RowEnd(y - 1, z));
+  if (previous_slice && z > 0) {
+    for (int ny = y - 1; ny <= y + 1; ++ny) {
+      if (0 <= ny && ny < cube.y_)
+        mergeRows(cube, uf, begin, end, cube.RowBegin(ny, z - 1), cube.RowEnd(ny, z - 1));
+    }
+  }
+}
+
+int LabelRuns(const RunLengthCube &cube, std::vector<int> &labels, int num_slabs) {
+  const int n = cube.NumRuns();
+  if (num_slabs <= 0)
+    num_slabs = GetNumThreads();
+  num_slabs = std::max(1, std::min(num_slabs, cube.z_));
+  DisjointSetInternal uf(n);
+  // A slab only merges its own runs, which are a contiguous range of `uf`,
+  // so slabs do not race even on path compression.
+#pragma omp parallel for schedule(dynamic)
+  for (int s = 0; s < num_slabs; ++s) {
+    const int z0 = (long long)cube.z_ * s / num_slabs;
+    const int z1 = (long long)cube.z_ * (s + 1) / num_slabs;
+    for (int z = z0; z < z1; ++z) {
+      for (int y = 0; y < cube.y_; ++y) {
+        mergeRow(cube, uf, y, z, true, z > z0);
+      }
+    }
+  }
+  // stitch the first slice of every slab to the last slice of the previous one
+  for (int s = 1; s < num_slabs; ++s) {
+    const int z0 = (long long)cube.z_ * s / num_slabs;
+    for (int y = 0; y < cube.y_; ++y) {
+      mergeRow(cube, uf, y, z0, false, true);
+    }
+  }
+  // Labels only depend on the partition, not on the order of merges, so
+  // they are the same for any number of slabs.
+  // the first run of a component is visited before any other one
+  std::vector<int> root_label(n, -1);
+  labels.resize(n);
+  int num_labels = 0;
+  for (int i = 0; i < n; ++i) {
+    const int root = uf.Root(i);
+    if (root_label[root] == -1)
+      root_label[root] = num_labels++;
+    labels[i] = root_label[root];
+  }
+  return num_labels;
+}
+} // namespace sigen
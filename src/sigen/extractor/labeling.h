@@ -0,0 +1,17 @@
+#pragma once
+#include "sigen/common/run_length_cube.h"
+#include <vector>
+namespace sigen {
+// Two-pass connected component labeling (26-neighborhood) of the runs of
+// `cube`. The raster scan gives every run a provisional label (its index)
+// and merges it with the overlapping runs of the four preceding rows in an
+// array-based union-find; the second pass relabels the roots.
+// labels[i] is the component of cube.runs_[i]. Components are numbered in
+// raster order of their first voxel, so labels are deterministic.
+// Returns the number of components. Time is linear in the number of runs.
+//
+// The volume is split into `num_slabs` z-slabs (one per thread if <= 0)
+// that are scanned in parallel; the union-find is then stitched across
+// slab boundaries. The labels do not depend on the number of slabs.
+int LabelRuns(const RunLengthCube &cube, std::vector<int> &labels, int num_slabs = 0);
+} // namespace sigen
@@ -0,0 +1,80 @@
+#include "sigen/extractor/prefilter.h"
+#include "sigen/common/parallel.h"
+#include <algorithm>
+#include <vector>
+namespace sigen {
+// Row `out` of the slice is cleared of voxels without a neighbor in `rows`
+// (the 3x3 rows around it, NULL for the frame; rows[4] is `out` itself).
+// `mask` clears x == 0 and x == x_ - 1.
+static void filterRow(const uint64_t *const rows[9], const uint64_t *mask, const int words, uint64_t *out) {
+  for (int i = 0; i < words; ++i) {
+    const uint64_t center = out[i] & mask[i];
+    if (center == 0) {
+      out[i] = 0;
+      continue;
+    }
+    uint64_t neighbor = 0;
+    for (int r = 0; r < 9; ++r) {
+      if (rows[r] == NULL)
+        continue;
+      const uint64_t w = rows[r][i] & mask[i];
+      const uint64_t lo = i > 0 ? rows[r][i - 1] & mask[i - 1] : 0;
+      const uint64_t hi = i + 1 < words ? rows[r][i + 1] & mask[i + 1] : 0;
+      neighbor |= (w << 1) | (w >> 1) | (lo >> 63) | (hi << 63);
+      if (r != 4)
+        neighbor |= w;
+    }
+    out[i] = center & neighbor;
+  }
+}
+
+void PrefilterSlice(BinaryCube &cube, const int z) {
+  const int words = cube.WordsPerRow();
+  if (words == 0)
+    return;
+  if (z == 0 || z == cube.z_ - 1) {
+    std::fill(cube.Row(0, z), cube.Row(0, z) + (size_t)words * cube.y_, 0);
+    return;
+  }
+  std::vector<uint64_t> mask(words, ~(uint64_t)0);
+  mask[0] &= ~(uint64_t)1;
+  mask[(cube.x_ - 1) >> 6] &= ~((uint64_t)1 << ((cube.x_ - 1) & 63));
+  for (int y = 0; y < cube.y_; ++y) {
+    uint64_t *row = cube.Row(y, z);
+    if (y == 0 || y == cube.y_ - 1) {
+      std::fill(row, row + words, 0);
+      continue;
+    }
+    const uint64_t *rows[9];
+    for (int dz = -1; dz <= 1; ++dz) {
+      for (int dy = -1; dy <= 1; ++dy) {
+        const int ny = y + dy, nz = z + dz;
+        const bool frame = ny == 0 || ny == cube.y_ - 1 || nz == 0 || nz == cube.z_ - 1;
+        rows[(dz + 1) * 3 + dy + 1] = frame ? NULL : cube.Row(ny, nz);
+      }
+    }
+    filterRow(rows, &mask[0], words, row);
+  }
+}
+
+// Slabs have two or more slices. Each slab first filters all but its last
+// slice, then the last slices are filtered; neither phase writes a slice
+// that another thread reads.
+void Prefilter(BinaryCube &cube) {
+  const int num_slabs = std::max(1, std::min(GetNumThreads(), cube.z_ / 2));
+#pragma omp parallel for schedule(dynamic)
+  for (int s = 0; s < num_slabs; ++s) {
+    const int z0 = (long long)cube.z_ * s / num_slabs;
+    const int z1 = (long long)cube.z_ * (s + 1) / num_slabs;
+    for (int z = z0; z < z1 - 1; ++z) {
+      PrefilterSlice(cube, z);
+    }
+  }
+#pragma omp parallel for schedule(dynamic)
+  for (int s = 0; s < num_slabs; ++s) {
+    const int z1 = (long long)cube.z_ * (s + 1) / num_slabs;
+    if (z1 > 0)
+      PrefilterSlice(cube, z1 - 1);
+  }
+}
+} // namespace sigen
@@ -0,0 +1,19 @@
+#pragma once
+#include "sigen/common/binary_cube.h"
+namespace sigen {
+// Clears the frame of the volume and removes isolated voxels (those without
+// a foreground voxel among their 26 neighbors), as Extractor does before
+// labeling.
+//
+// A row is filtered a word at a time: the neighbors of 64 voxels are the
+// bitwise OR of the shifted words of the nine adjacent rows in the slices
+// z - 1, z and z + 1. Removing an isolated voxel never changes the result
+// for another one, so slices are filtered in place without copying.
+
+// Filters slice z of `cube`. Slices z - 1 and z + 1 must be binarized, and
+// may already be filtered, so binarization can call this for slice z - 1
+// right after writing slice z.
+void PrefilterSlice(BinaryCube &cube, int z);
+// filters every slice, in parallel over z-slabs
+void Prefilter(BinaryCube &cube);
+} // namespace sigen
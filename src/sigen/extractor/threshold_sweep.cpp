@@ -0,0 +1,143 @@
+#include "sigen/extractor/threshold_sweep.h"
+#include <algorithm>
+#include <cassert>
+#include <functional>
+namespace sigen {
+namespace {
+struct IndexLess {
+  template <class C>
+  bool operator()(const C &a, const C &b) const { return a.index_ < b.index_; }
+};
+struct IndexBelow {
+  template <class C>
+  bool operator()(const C &a, const long long index) const { return a.index_ < index; }
+};
+// descending order of value, then ascending order of index
+template <class C>
+struct ValueGreater {
+  const std::vector<C> &candidates_;
+  explicit ValueGreater(const std::vector<C> &candidates) : candidates_(candidates) {}
+  bool operator()(const int a, const int b) const {
+    if (candidates_[a].value_ != candidates_[b].value_)
+      return candidates_[a].value_ > candidates_[b].value_;
+    return a < b;
+  }
+};
+} // namespace
+
+ThresholdSweep::ThresholdSweep(int x, int y, int z, double min_thresh, bool inclusive)
+    : x_(x), y_(y), z_(z), min_thresh_(min_thresh), inclusive_(inclusive), uf_(0), next_(0) {
+  stats_.thresh_ = 0;
+  stats_.num_components_ = 0;
+  stats_.num_voxels_ = 0;
+  stats_.largest_component_ = 0;
+}
+
+template <class T>
+void ThresholdSweep::addRow(int y, int z, const T *src, std::ptrdiff_t stride_x) {
+  assert(0 <= y && y < y_ && 0 <= z && z < z_);
+  // the frame is cleared by Extractor
+  if (y == 0 || y == y_ - 1 || z == 0 || z == z_ - 1)
+    return;
+  const long long row = ((long long)z * y_ + y) * x_;
+  for (int x = 1; x < x_ - 1; ++x) {
+    const float value = (float)src[stride_x * x];
+    if (isForeground(value, min_thresh_)) {
+      Candidate c;
+      c.index_ = row + x;
+      c.value_ = value;
+      candidates_.push_back(c);
+    }
+  }
+}
+
+void ThresholdSweep::AddRow(int y, int z, const uint8_t *src, std::ptrdiff_t stride_x) {
+  addRow(y, z, src, stride_x);
+}
+
+void ThresholdSweep::AddRow(int y, int z, const uint16_t *src, std::ptrdiff_t stride_x) {
+  addRow(y, z, src, stride_x);
+}
+
+void ThresholdSweep::AddRow(int y, int z, const float *src, std::ptrdiff_t stride_x) {
+  addRow(y, z, src, stride_x);
+}
+
+void ThresholdSweep::SetUp() {
+  std::sort(candidates_.begin(), candidates_.end(), IndexLess());
+  const int n = candidates_.size();
+  order_.resize(n);
+  for (int i = 0; i < n; ++i) {
+    order_[i] = i;
+  }
+  std::sort(order_.begin(), order_.end(), ValueGreater<Candidate>(candidates_));
+  added_.assign(n, 0);
+  uf_ = DisjointSetInternal(n);
+  next_ = 0;
+}
+
+void ThresholdSweep::add(int id) {
+  added_[id] = 1;
+  const long long index = candidates_[id].index_;
+  for (int dz = -1; dz <= 1; ++dz) {
+    for (int dy = -1; dy <= 1; ++dy) {
+      // x - 1, x, x + 1 of a neighbor row are consecutive candidates, if any
+      const long long first = index + ((long long)dz * y_ + dy) * x_ - 1;
+      const int lo = dz < 0 || (dz == 0 && dy <= 0) ? 0 : id;
+      std::vector<Candidate>::const_iterator it =
+          std::lower_bound(candidates_.begin() + lo, candidates_.end(), first, IndexBelow());
+      for (; it != candidates_.end() && it->index_ <= first + 2; ++it) {
+        const int nid = it - candidates_.begin();
+        if (nid == id || !added_[nid] || uf_.Same(id, nid))
+          continue;
+        const int a = uf_.Size(id), b = uf_.Size(nid);
+        stats_.num_components_ += 1 - (a >= 2) - (b >= 2);
+        stats_.num_voxels_ += (a < 2 ? a : 0) + (b < 2 ? b : 0);
+        stats_.largest_component_ = std::max(stats_.largest_component_, a + b);
+        uf_.Merge(id, nid);
+      }
+    }
+  }
+}
+
+void ThresholdSweep::Lower(double thresh) {
+  assert(next_ == 0 || thresh <= stats_.thresh_);
+  while (next_ < (int)order_.size() && isForeground(candidates_[order_[next_]].value_, thresh)) {
+    add(order_[next_++]);
+  }
+  stats_.thresh_ = thresh;
+}
+
+RunLengthCube ThresholdSweep::Foreground() const {
+  RunLengthCube cube(x_, y_, z_);
+  const int n = candidates_.size();
+  int i = 0;
+  while (i < n) {
+    if (!added_[i]) {
+      ++i;
+      continue;
+    }
+    // extend the run while the next voxel of the row is also added
+    const long long begin = candidates_[i].index_;
+    int j = i + 1;
+    while (j < n && added_[j] && candidates_[j].index_ == begin + (j - i))
+      ++j;
+    const long long row = begin / x_;
+    const int x = begin % x_;
+    cube.AppendRun(row % y_, row / y_, x, x + (j - i));
+    i = j;
+  }
+  return cube;
+}
+
+std::vector<SweepStats> ThresholdSweep::Run(std::vector<double> thresholds) {
+  std::sort(thresholds.begin(), thresholds.end(), std::greater<double>());
+  SetUp();
+  std::vector<SweepStats> ret;
+  for (int i = 0; i < (int)thresholds.size(); ++i) {
+    Lower(thresholds[i]);
+    ret.push_back(stats_);
+  }
+  return ret;
+}
+} // namespace sigen
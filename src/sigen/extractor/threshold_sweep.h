@@ -0,0 +1,63 @@
+#pragma once
+#include "sigen/common/disjoint_set.h"
+#include "sigen/common/run_length_cube.h"
+#include <boost/utility.hpp>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+namespace sigen {
+// component statistics of the volume binarized at thresh_
+struct SweepStats {
+  double thresh_;
+  int num_components_;   // components of two or more voxels
+  long long num_voxels_; // voxels in those components
+  int largest_component_;
+};
+
+// Connected components (26-neighborhood) of one volume for many thresholds.
+// Candidate voxels are sorted by intensity once and added to a union-find
+// in descending order, so lowering the threshold only costs the voxels
+// between the old and the new threshold.
+// As in Extractor, voxels on the frame of the volume are ignored, and
+// isolated voxels are not counted as components.
+class ThresholdSweep : boost::noncopyable {
+  struct Candidate {
+    long long index_; // (z * y_ + y) * x_ + x
+    float value_;     // exact for 8-bit, 16-bit and float voxels
+  };
+  int x_, y_, z_;
+  double min_thresh_;
+  bool inclusive_;
+  std::vector<Candidate> candidates_; // ascending order of index_ after SetUp
+  std::vector<int> order_;            // candidates in descending order of value_
+  std::vector<char> added_;
+  DisjointSetInternal uf_;
+  int next_; // order_[next_] is the next candidate to add
+  SweepStats stats_;
+
+  template <class T>
+  void addRow(int y, int z, const T *src, std::ptrdiff_t stride_x);
+  bool isForeground(const float value, const double thresh) const {
+    return inclusive_ ? value >= thresh : value > thresh;
+  }
+  void add(int id);
+
+public:
+  // foreground if val > thresh (as Binarizer), or val >= thresh if `inclusive`
+  // (as interface::Options). Voxels below min_thresh are never added.
+  ThresholdSweep(int x, int y, int z, double min_thresh, bool inclusive);
+  // voxel x of row (y, z) is src[stride_x * x]; rows may come in any order
+  void AddRow(int y, int z, const uint8_t *src, std::ptrdiff_t stride_x);
+  void AddRow(int y, int z, const uint16_t *src, std::ptrdiff_t stride_x);
+  void AddRow(int y, int z, const float *src, std::ptrdiff_t stride_x);
+  // call once after every row is added
+  void SetUp();
+  // Adds voxels down to `thresh`. Thresholds must not increase between calls.
+  void Lower(double thresh);
+  const SweepStats &Stats() const { return stats_; }
+  // the binarized volume at the current threshold (frame cleared)
+  RunLengthCube Foreground() const;
+  // SetUp() and Lower() for each of `thresholds` (in descending order)
+  std::vector<SweepStats> Run(std::vector<double> thresholds);
+};
+} // namespace sigen
@@ -0,0 +1,117 @@
+#include "sigen/extractor/tiled_extractor.h"
+#include "sigen/extractor/extractor.h"
+#include "sigen/extractor/prefilter.h"
+#include <algorithm>
+#include <cassert>
+namespace sigen {
+TiledExtractor::TiledExtractor(const int x, const int y, const int z, const int depth)
+    : x_(x), y_(y), z_(z), depth_(depth), scale_xy_(1.0), scale_z_(1.0), summarize_(true) {
+  assert(depth > 0);
+  const int n = (z + depth - 1) / depth;
+  clusters_.resize(n);
+  lower_.resize(n);
+  upper_.resize(n);
+}
+
+int TiledExtractor::ZBegin(const int t) const {
+  return std::max(0, t * depth_ - kHalo);
+}
+
+int TiledExtractor::ZEnd(const int t) const {
+  return std::min(z_, (t + 1) * depth_ + kHalo);
+}
+
+// The prefilter clears the first and last slices of the tile as the frame,
+// which is right at the bounds of the volume and only loses the outer halo
+// slice elsewhere: the inner halo slice keeps its voxels, so voxels of the
+// own slices are removed exactly when the whole volume would remove them.
+void TiledExtractor::ExtractTile(const int t, BOOST_RV_REF(BinaryCube) cube) {
+  const int z_begin = ZBegin(t);
+  const int own_begin = t * depth_ - z_begin;
+  const int own_end = std::min(z_, (t + 1) * depth_) - z_begin;
+  assert(cube.x_ == x_ && cube.y_ == y_ && cube.z_ == ZEnd(t) - z_begin);
+  Prefilter(cube);
+  const size_t slice_words = (size_t)cube.WordsPerRow() * cube.y_;
+  for (int z = 0; z < cube.z_; ++z) {
+    if (z < own_begin || own_end <= z)
+      std::fill(cube.Row(0, z), cube.Row(0, z) + slice_words, 0);
+  }
+
+  Extractor ext(boost::move(cube));
+  ext.filtered_ = true;
+  ext.summarize_ = summarize_;
+  ext.scale_xy_ = scale_xy_;
+  ext.scale_z_ = scale_z_;
+  ClusterStore clusters = ext.Extract();
+  for (size_t i = 0; i < clusters.gz_.size(); ++i) {
+    clusters.gz_[i] += z_begin;
+  }
+  for (size_t i = 0; i < clusters.points_.size(); ++i) {
+    clusters.points_[i].z_ += z_begin;
+  }
+  clusters_[t] = boost::move(clusters);
+
+  // voxels are in raster order, so the faces are too
+  Face &lower = lower_[t], &upper = upper_[t];
+  lower.clear();
+  upper.clear();
+  for (size_t i = 0; i < ext.voxels_.size(); ++i) {
+    const Voxel &v = ext.voxels_[i];
+    if (v.z_ == own_begin)
+      lower.push_back(std::make_pair(v.y_ * x_ + v.x_, v.label_));
+    if (v.z_ == own_end - 1)
+      upper.push_back(std::make_pair(v.y_ * x_ + v.x_, v.label_));
+  }
+}
+
+// The last own slice of tile t and the first of tile t + 1 are adjacent,
+// so a voxel of one face touches the nine voxels around it on the other.
+ClusterStore TiledExtractor::Stitch() {
+  const int n = NumTiles();
+  size_t num_points = 0, num_clusters = 0, num_edges = 0;
+  for (int t = 0; t < n; ++t) {
+    num_points += clusters_[t].points_.size();
+    num_clusters += clusters_[t].size();
+    num_edges += clusters_[t].edges_.size();
+  }
+  ClusterStore ret;
+  ret.points_.reserve(num_points);
+  ret.offsets_.reserve(num_clusters + 1);
+  ret.gx_.reserve(num_clusters);
+  ret.gy_.reserve(num_clusters);
+  ret.gz_.reserve(num_clusters);
+  ret.radius_.reserve(num_clusters);
+  ret.edges_.reserve(num_edges);
+  std::vector<int> bases(n);
+  for (int t = 0; t < n; ++t) {
+    bases[t] = ret.size();
+    ret.Append(clusters_[t]);
+    clusters_[t].Clear();
+  }
+
+  for (int t = 0; t + 1 < n; ++t) {
+    const Face &upper = upper_[t], &lower = lower_[t + 1];
+    for (size_t i = 0; i < upper.size(); ++i) {
+      const int x = upper[i].first % x_, y = upper[i].first / x_;
+      for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+          const int nx = x + dx, ny = y + dy;
+          if (nx < 0 || x_ <= nx || ny < 0 || y_ <= ny)
+            continue;
+          const std::pair<int, int> key(ny * x_ + nx, -1);
+          Face::const_iterator it = std::lower_bound(lower.begin(), lower.end(), key);
+          if (it != lower.end() && it->first == key.first)
+            ret.edges_.push_back(std::make_pair(bases[t] + upper[i].second, bases[t + 1] + it->second));
+        }
+      }
+    }
+    Face().swap(upper_[t]);
+    Face().swap(lower_[t + 1]);
+  }
+  std::sort(ret.edges_.begin(), ret.edges_.end());
+  ret.edges_.erase(std::unique(ret.edges_.begin(), ret.edges_.end()), ret.edges_.end());
+  ret.has_summary_ = summarize_;
+  ret.has_edges_ = true;
+  return ret;
+}
+} // namespace sigen
@@ -0,0 +1,46 @@
+#pragma once
+#include "sigen/common/binary_cube.h"
+#include "sigen/common/cluster_store.h"
+#include <boost/move/core.hpp>
+#include <boost/utility.hpp>
+#include <utility>
+#include <vector>
+namespace sigen {
+// Extraction of a volume that does not fit in memory, a z-slab (tile) at a
+// time. Tile t owns slices [t * depth_, (t + 1) * depth_) and is binarized
+// with kHalo more slices on each side, so the prefilter of its own slices
+// sees all of their neighbors; the halo is cleared before extraction.
+// Each tile is extracted with Extractor::summarize_ and keeps only its
+// cluster summaries (unless summarize_ is cleared) and the clusters of the voxels on its first and last
+// own slices (its faces). Stitch() joins the clusters that touch across
+// the face between two tiles, which also merges their components.
+//
+// Geodesic distances are computed within a tile, so a neurite crossing a
+// face is split into level sets there, unlike Extractor on the whole
+// volume. Memory is bounded by the tile and the cluster summaries.
+class TiledExtractor : boost::noncopyable {
+  // (y * x_ + x, cluster) of the voxels of a face, in raster order
+  typedef std::vector<std::pair<int, int> > Face;
+  std::vector<ClusterStore> clusters_;
+  std::vector<Face> lower_, upper_;
+
+public:
+  static const int kHalo = 2;
+  int x_, y_, z_, depth_;
+  double scale_xy_, scale_z_;
+  // If cleared, the tiles keep the points of their clusters (in volume
+  // coordinates) for Builder to summarize, at the cost of the memory bound.
+  bool summarize_;
+  TiledExtractor(int x, int y, int z, int depth);
+  int NumTiles() const { return clusters_.size(); }
+  // slices [ZBegin(t), ZEnd(t)) of the volume (with the halo) form tile t
+  int ZBegin(int t) const;
+  int ZEnd(int t) const;
+  // Extracts tile t from `cube`, slices [ZBegin(t), ZEnd(t)) of the
+  // binarized volume. Different tiles may be extracted concurrently.
+  void ExtractTile(int t, BOOST_RV_REF(BinaryCube) cube);
+  // Concatenates the clusters of the tiles in order, and adds the edges
+  // between tiles. Call once after every tile is extracted.
+  ClusterStore Stitch();
+};
+} // namespace sigen
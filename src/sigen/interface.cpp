@@ -1,8 +1,10 @@
 #include "sigen/interface.h"
 #include "sigen/builder/builder.h"
 #include "sigen/common/binary_cube.h"
+#include "sigen/common/threshold.h"
 #include "sigen/extractor/extractor.h"
 #include "sigen/toolbox/toolbox.h"
+#include <algorithm>
 #include <boost/foreach.hpp>
 #include <cassert>
 #include <iostream>
@@ -47,20 +49,23 @@ static void write(
   }
 }
 
-void Extract(
-    const BinaryCube &cube,
+static void extract(
+    Extractor &ext,
     std::vector<int> &out_n, std::vector<int> &out_type,
     std::vector<double> &out_x, std::vector<double> &out_y, std::vector<double> &out_z,
     std::vector<double> &out_r, std::vector<int> &out_pn,
     const Options &options) {
   bool print_progress = true;
-  sigen::Extractor ext(cube);
   if (print_progress)
     std::cerr << "extract start" << std::endl;
-  std::vector<ClusterPtr> clusters = ext.Extract();
+  ext.summarize_ = true;
+  ext.scale_xy_ = options.scale_xy;
+  ext.scale_z_ = options.scale_z;
+  ext.min_component_voxels_ = options.min_component_voxels;
+  ClusterStore clusters = ext.Extract();
   if (print_progress)
     std::cerr << "extract finished" << std::endl;
-  sigen::Builder bld(clusters, options.scale_xy, options.scale_z);
+  sigen::Builder bld(boost::move(clusters), options.scale_xy, options.scale_z);
   std::vector<sigen::Neuron> neurons = bld.Build();
   if (print_progress)
     std::cerr << "build finished" << std::endl;
@@ -87,5 +92,187 @@ void Extract(
     write(neurons[i].get_root(), -1, out_n, out_type, out_x, out_y, out_z, out_r, out_pn);
   }
 }
+
+void Extract(
+    const BinaryCube &cube,
+    std::vector<int> &out_n, std::vector<int> &out_type,
+    std::vector<double> &out_x, std::vector<double> &out_y, std::vector<double> &out_z,
+    std::vector<double> &out_r, std::vector<int> &out_pn,
+    const Options &options) {
+  sigen::Extractor ext(cube);
+  extract(ext, out_n, out_type, out_x, out_y, out_z, out_r, out_pn, options);
+}
+
+void Extract(
+    const RunLengthCube &cube,
+    std::vector<int> &out_n, std::vector<int> &out_type,
+    std::vector<double> &out_x, std::vector<double> &out_y, std::vector<double> &out_z,
+    std::vector<double> &out_r, std::vector<int> &out_pn,
+    const Options &options) {
+  sigen::Extractor ext(cube);
+  extract(ext, out_n, out_type, out_x, out_y, out_z, out_r, out_pn, options);
+}
+
+// one pass in memory order: the only buffer is the runs of the output
+template <class T>
+static RunLengthCube thresholdToRuns(
+    const T *data,
+    const int xdim, const int ydim, const int zdim,
+    const std::ptrdiff_t stride_x, const std::ptrdiff_t stride_y,
+    const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+    const int channel, const double thresh) {
+  RunLengthCube cube(xdim, ydim, zdim);
+  for (int z = 0; z < zdim; ++z) {
+    for (int y = 0; y < ydim; ++y) {
+      const T *src = data + stride_y * y + stride_z * z + stride_c * channel;
+      int x = 0;
+      while (x < xdim) {
+        while (x < xdim && !(src[stride_x * x] >= thresh))
+          ++x;
+        const int begin = x;
+        while (x < xdim && src[stride_x * x] >= thresh)
+          ++x;
+        if (begin < x)
+          cube.AppendRun(y, z, begin, x);
+      }
+    }
+  }
+  return cube;
+}
+
+// contiguous rows are packed with SIMD and then encoded
+template <class T>
+static RunLengthCube packToRuns(
+    const T *data,
+    const int xdim, const int ydim, const int zdim,
+    const std::ptrdiff_t stride_y, const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+    const int channel, const double thresh) {
+  RunLengthCube cube(xdim, ydim, zdim);
+  std::vector<uint64_t> row((xdim + 63) / 64);
+  for (int z = 0; z < zdim; ++z) {
+    for (int y = 0; y < ydim; ++y) {
+      const T *src = data + stride_y * y + stride_z * z + stride_c * channel;
+      PackGreaterEqual(src, xdim, thresh, &row[0]);
+      cube.AppendRow(y, z, &row[0]);
+    }
+  }
+  return cube;
+}
+
+template <class T>
+static void extractRaw(
+    const T *data,
+    const int xdim, const int ydim, const int zdim,
+    const std::ptrdiff_t stride_x, const std::ptrdiff_t stride_y,
+    const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+    const int channel,
+    std::vector<int> &out_n, std::vector<int> &out_type,
+    std::vector<double> &out_x, std::vector<double> &out_y, std::vector<double> &out_z,
+    std::vector<double> &out_r, std::vector<int> &out_pn,
+    const Options &options) {
+  RunLengthCube cube = stride_x == 1
+                           ? packToRuns(data, xdim, ydim, zdim, stride_y, stride_z, stride_c,
+                                        channel, options.binarization_thresh)
+                           : thresholdToRuns(data, xdim, ydim, zdim, stride_x, stride_y, stride_z, stride_c,
+                                             channel, options.binarization_thresh);
+  sigen::Extractor ext(boost::move(cube));
+  extract(ext, out_n, out_type, out_x, out_y, out_z, out_r, out_pn, options);
+}
+
+void Extract(
+    const unsigned char *data,
+    const int xdim, const int ydim, const int zdim,
+    const std::ptrdiff_t stride_x, const std::ptrdiff_t stride_y,
+    const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+    const int channel,
+    std::vector<int> &out_n, std::vector<int> &out_type,
+    std::vector<double> &out_x, std::vector<double> &out_y, std::vector<double> &out_z,
+    std::vector<double> &out_r, std::vector<int> &out_pn,
+    const Options &options) {
+  extractRaw(data, xdim, ydim, zdim, stride_x, stride_y, stride_z, stride_c, channel,
+             out_n, out_type, out_x, out_y, out_z, out_r, out_pn, options);
+}
+
+void Extract(
+    const unsigned short *data,
+    const int xdim, const int ydim, const int zdim,
+    const std::ptrdiff_t stride_x, const std::ptrdiff_t stride_y,
+    const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+    const int channel,
+    std::vector<int> &out_n, std::vector<int> &out_type,
+    std::vector<double> &out_x, std::vector<double> &out_y, std::vector<double> &out_z,
+    std::vector<double> &out_r, std::vector<int> &out_pn,
+    const Options &options) {
+  extractRaw(data, xdim, ydim, zdim, stride_x, stride_y, stride_z, stride_c, channel,
+             out_n, out_type, out_x, out_y, out_z, out_r, out_pn, options);
+}
+
+void Extract(
+    const float *data,
+    const int xdim, const int ydim, const int zdim,
+    const std::ptrdiff_t stride_x, const std::ptrdiff_t stride_y,
+    const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+    const int channel,
+    std::vector<int> &out_n, std::vector<int> &out_type,
+    std::vector<double> &out_x, std::vector<double> &out_y, std::vector<double> &out_z,
+    std::vector<double> &out_r, std::vector<int> &out_pn,
+    const Options &options) {
+  extractRaw(data, xdim, ydim, zdim, stride_x, stride_y, stride_z, stride_c, channel,
+             out_n, out_type, out_x, out_y, out_z, out_r, out_pn, options);
+}
+template <class T>
+static void sweepRaw(
+    const T *data,
+    const int xdim, const int ydim, const int zdim,
+    const std::ptrdiff_t stride_x, const std::ptrdiff_t stride_y,
+    const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+    const int channel, const std::vector<double> &thresholds,
+    std::vector<SweepStats> &out_stats) {
+  out_stats.clear();
+  if (thresholds.empty())
+    return;
+  ThresholdSweep sweep(xdim, ydim, zdim,
+                       *std::min_element(thresholds.begin(), thresholds.end()),
+                       /* inclusive = */ true);
+  for (int z = 0; z < zdim; ++z) {
+    for (int y = 0; y < ydim; ++y) {
+      sweep.AddRow(y, z, data + stride_y * y + stride_z * z + stride_c * channel, stride_x);
+    }
+  }
+  out_stats = sweep.Run(thresholds);
+}
+
+void SweepThresholds(
+    const unsigned char *data,
+    const int xdim, const int ydim, const int zdim,
+    const std::ptrdiff_t stride_x, const std::ptrdiff_t stride_y,
+    const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+    const int channel, const std::vector<double> &thresholds,
+    std::vector<SweepStats> &out_stats) {
+  sweepRaw(data, xdim, ydim, zdim, stride_x, stride_y, stride_z, stride_c,
+           channel, thresholds, out_stats);
+}
+
+void SweepThresholds(
+    const unsigned short *data,
+    const int xdim, const int ydim, const int zdim,
+    const std::ptrdiff_t stride_x, const std::ptrdiff_t stride_y,
+    const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+    const int channel, const std::vector<double> &thresholds,
+    std::vector<SweepStats> &out_stats) {
+  sweepRaw(data, xdim, ydim, zdim, stride_x, stride_y, stride_z, stride_c,
+           channel, thresholds, out_stats);
+}
+
+void SweepThresholds(
+    const float *data,
+    const int xdim, const int ydim, const int zdim,
+    const std::ptrdiff_t stride_x, const std::ptrdiff_t stride_y,
+    const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+    const int channel, const std::vector<double> &thresholds,
+    std::vector<SweepStats> &out_stats) {
+  sweepRaw(data, xdim, ydim, zdim, stride_x, stride_y, stride_z, stride_c,
+           channel, thresholds, out_stats);
+}
 } // namespace interface
 } // namespace sigen
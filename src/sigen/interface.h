@@ -1,5 +1,8 @@
 #pragma once
 #include "sigen/common/binary_cube.h"
+#include "sigen/common/run_length_cube.h"
+#include "sigen/extractor/threshold_sweep.h"
+#include <cstddef>
 #include <vector>
 namespace sigen {
 namespace interface {
@@ -14,11 +17,68 @@ public:
   int smoothing_level;
   bool enable_clipping;
   int clipping_level;
-  int binarization_thresh;
+  double binarization_thresh;
+  // components of fewer voxels are dropped before extraction (0: keep all)
+  int min_component_voxels;
 };
 void Extract(const BinaryCube &cube,
              std::vector<int> &out_n, std::vector<int> &out_type,
              std::vector<double> &out_x, std::vector<double> &out_y, std::vector<double> &out_z,
              std::vector<double> &out_r, std::vector<int> &out_pn, const Options &options);
+void Extract(const RunLengthCube &cube,
+             std::vector<int> &out_n, std::vector<int> &out_type,
+             std::vector<double> &out_x, std::vector<double> &out_y, std::vector<double> &out_z,
+             std::vector<double> &out_r, std::vector<int> &out_pn, const Options &options);
+// Binarizes a raw buffer on the fly (foreground if voxel >= binarization_thresh)
+// and traces it without materializing a full-resolution cube.
+// Voxel (x, y, z) is data[stride_x * x + stride_y * y + stride_z * z + stride_c * channel].
+// Strides are in elements, e.g. 1, xdim, xdim * ydim, xdim * ydim * zdim for Vaa3D.
+void Extract(const unsigned char *data,
+             const int xdim, const int ydim, const int zdim,
+             const std::ptrdiff_t stride_x, const std::ptrdiff_t stride_y,
+             const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+             const int channel,
+             std::vector<int> &out_n, std::vector<int> &out_type,
+             std::vector<double> &out_x, std::vector<double> &out_y, std::vector<double> &out_z,
+             std::vector<double> &out_r, std::vector<int> &out_pn, const Options &options);
+// 16-bit voxels
+void Extract(const unsigned short *data,
+             const int xdim, const int ydim, const int zdim,
+             const std::ptrdiff_t stride_x, const std::ptrdiff_t stride_y,
+             const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+             const int channel,
+             std::vector<int> &out_n, std::vector<int> &out_type,
+             std::vector<double> &out_x, std::vector<double> &out_y, std::vector<double> &out_z,
+             std::vector<double> &out_r, std::vector<int> &out_pn, const Options &options);
+// 32-bit float voxels
+void Extract(const float *data,
+             const int xdim, const int ydim, const int zdim,
+             const std::ptrdiff_t stride_x, const std::ptrdiff_t stride_y,
+             const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+             const int channel,
+             std::vector<int> &out_n, std::vector<int> &out_type,
+             std::vector<double> &out_x, std::vector<double> &out_y, std::vector<double> &out_z,
+             std::vector<double> &out_r, std::vector<int> &out_pn, const Options &options);
+// Component statistics of a raw buffer (see Extract) for every threshold of
+// `thresholds` (foreground if voxel >= threshold), in descending order of
+// threshold. The buffer is read once, whatever the number of thresholds.
+void SweepThresholds(const unsigned char *data,
+                     const int xdim, const int ydim, const int zdim,
+                     const std::ptrdiff_t stride_x, const std::ptrdiff_t stride_y,
+                     const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+                     const int channel, const std::vector<double> &thresholds,
+                     std::vector<SweepStats> &out_stats);
+void SweepThresholds(const unsigned short *data,
+                     const int xdim, const int ydim, const int zdim,
+                     const std::ptrdiff_t stride_x, const std::ptrdiff_t stride_y,
+                     const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+                     const int channel, const std::vector<double> &thresholds,
+                     std::vector<SweepStats> &out_stats);
+void SweepThresholds(const float *data,
+                     const int xdim, const int ydim, const int zdim,
+                     const std::ptrdiff_t stride_x, const std::ptrdiff_t stride_y,
+                     const std::ptrdiff_t stride_z, const std::ptrdiff_t stride_c,
+                     const int channel, const std::vector<double> &thresholds,
+                     std::vector<SweepStats> &out_stats);
 } // namespace interface
 } // namespace sigen
@@ -0,0 +1,90 @@
+#include "sigen/loader/cube_cache.h"
+#include "sigen/loader/file_loader.h"
+#include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+#include <cstdio>
+#include <fstream>
+#include <glog/logging.h>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+namespace sigen {
+// FNV-1a
+static uint64_t hashString(const std::string &s) {
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0; i < s.size(); ++i) {
+    h ^= (unsigned char)s[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+static std::string readFile(const std::string &path) {
+  std::ifstream ifs(path.c_str(), std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+
+CubeCache::CubeCache(const std::string &dir) : dir_(dir) {
+  boost::filesystem::create_directories(dir_);
+}
+
+std::string CubeCache::path(const std::string &key, const std::string &ext) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)hashString(key));
+  return (boost::filesystem::path(dir_) / (name + ext)).string();
+}
+
+std::string CubeCache::Key(const std::string &input, const double thresh, const bool raw_thresh, const int channel) {
+  namespace fs = boost::filesystem;
+  std::vector<std::string> files;
+  if (fs::is_regular_file(input)) {
+    files.push_back(input);
+  } else {
+    files = FileLoader::ListImageFiles(input);
+  }
+  std::ostringstream ss;
+  ss.precision(17);
+  ss << "sigen cube cache 3\n"
+     << "prefiltered\n"
+     << "thresh " << thresh << (raw_thresh ? " raw" : " 8-bit") << "\n"
+     << "channel " << channel << "\n";
+  BOOST_FOREACH (const std::string &f, files) {
+    ss << fs::absolute(f).string() << " " << fs::file_size(f) << " " << fs::last_write_time(f) << "\n";
+  }
+  return ss.str();
+}
+
+bool CubeCache::Find(const std::string &key, BinaryCube &cube) const {
+  const std::string key_path = path(key, ".key");
+  if (!boost::filesystem::exists(key_path) || readFile(key_path) != key)
+    return false;
+  try {
+    cube = BinaryCube::OpenMapped(path(key, ".cube"), /* read_only = */ true);
+  } catch (const std::exception &e) {
+    LOG(WARNING) << "ignore broken cache entry: " << e.what();
+    return false;
+  }
+  return true;
+}
+
+BinaryCube CubeCache::Create(const std::string &key, int x, int y, int z) const {
+  // a stale entry must not match while the new one is written
+  boost::filesystem::remove(path(key, ".key"));
+  return BinaryCube::CreateMapped(path(key, ".cube"), x, y, z);
+}
+
+void CubeCache::Commit(const std::string &key, BinaryCube &cube) const {
+  cube.Flush();
+  const std::string key_path = path(key, ".key");
+  const std::string tmp_path = key_path + ".tmp";
+  {
+    std::ofstream ofs(tmp_path.c_str(), std::ios::binary);
+    ofs << key;
+    CHECK(ofs) << "cannot write " << tmp_path;
+  }
+  boost::filesystem::rename(tmp_path, key_path);
+}
+} // namespace sigen
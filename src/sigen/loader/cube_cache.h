@@ -0,0 +1,27 @@
+#pragma once
+#include "sigen/common/binary_cube.h"
+#include <string>
+namespace sigen {
+// On-disk cache of binarized cubes, in the file format of
+// BinaryCube::CreateMapped, so a hit is mapped instead of read. Entries
+// hold the cube after Prefilter (see Extractor::filtered_).
+// An entry is <hash>.cube plus <hash>.key, which holds the full key and is
+// written last, so an interrupted run leaves no valid entry behind.
+class CubeCache {
+  std::string dir_;
+  std::string path(const std::string &key, const std::string &ext) const;
+
+public:
+  explicit CubeCache(const std::string &dir);
+  // Describes `input` (image directory or volume file) binarized at `thresh`:
+  // the names, sizes and modification times of its image files, and the
+  // threshold (on the 8-bit scale, or compared with raw values if
+  // `raw_thresh`) and channel.
+  static std::string Key(const std::string &input, const double thresh, const bool raw_thresh, const int channel);
+  // maps the cached cube of `key` read-only, if there is one
+  bool Find(const std::string &key, BinaryCube &cube) const;
+  // a mapped cube to binarize into, then pass to Commit
+  BinaryCube Create(const std::string &key, int x, int y, int z) const;
+  void Commit(const std::string &key, BinaryCube &cube) const;
+};
+} // namespace sigen
@@ -2,6 +2,9 @@
 #include <algorithm>
 #include <boost/filesystem.hpp>
 #include <boost/foreach.hpp>
+#include <cctype>
+#include <cstring>
+#include <fstream>
 #include <glog/logging.h>
 #include <string>
 #include <vector>
@@ -13,26 +16,100 @@
 #pragma GCC diagnostic pop
 
 namespace sigen {
-ImageSequence FileLoader::Load(const std::string &dir_path) {
+// extensions OpenCV decodes
+static bool hasImageExtension(const boost::filesystem::path &path) {
+  static const char *const kExtensions[] = {
+      ".tif", ".tiff", ".png", ".bmp", ".dib", ".jpg", ".jpeg", ".jpe", ".jp2",
+      ".pbm", ".pgm", ".ppm", ".pxm", ".pnm", ".sr", ".ras", ".webp", ".exr", ".hdr"};
+  std::string ext = path.extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+  for (int i = 0; i < (int)(sizeof(kExtensions) / sizeof(kExtensions[0])); ++i) {
+    if (ext == kExtensions[i])
+      return true;
+  }
+  return false;
+}
+
+// TIFF, PNG, BMP, JPEG, PNM
+static bool hasImageMagic(const std::string &path) {
+  unsigned char m[4] = {0, 0, 0, 0};
+  std::ifstream ifs(path.c_str(), std::ios::binary);
+  ifs.read((char *)m, sizeof(m));
+  if (ifs.gcount() < 2)
+    return false;
+  return (m[0] == 'I' && m[1] == 'I' && m[2] == 42 && m[3] == 0) ||
+         (m[0] == 'M' && m[1] == 'M' && m[2] == 0 && m[3] == 42) ||
+         std::memcmp(m, "\x89PNG", 4) == 0 ||
+         (m[0] == 'B' && m[1] == 'M') ||
+         (m[0] == 0xff && m[1] == 0xd8) ||
+         (m[0] == 'P' && '1' <= m[1] && m[1] <= '6');
+}
+
+std::vector<std::string> FileLoader::ListImageFiles(const std::string &dir_path) {
   namespace fs = boost::filesystem;
   std::vector<std::string> fnames;
   // enumerate files in specified directory
   fs::directory_iterator end;
   for (fs::directory_iterator it(dir_path); it != end; ++it) {
-    fnames.push_back(it->path().string());
+    if (!fs::is_regular_file(it->status()))
+      continue;
+    if (hasImageExtension(it->path()) || hasImageMagic(it->path().string()))
+      fnames.push_back(it->path().string());
   }
   // sort by file name in ascending order
   std::sort(fnames.begin(), fnames.end());
+  return fnames;
+}
+
+ImageSequence FileLoader::Load(const std::string &dir_path) {
+  const std::vector<std::string> fnames = ListImageFiles(dir_path);
+  std::vector<cv::Mat> images(fnames.size());
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < (int)fnames.size(); ++i) {
+    // LOG(INFO) << fnames[i];
+    images[i] = cv::imread(fnames[i], cv::IMREAD_ANYDEPTH /* grayscale, 8/16-bit or float */);
+  }
   ImageSequence ret;
-  BOOST_FOREACH (const std::string &entry, fnames) {
-    // LOG(INFO) << entry;
-    cv::Mat im = cv::imread(entry, 0 /* grayscale */);
+  BOOST_FOREACH (const cv::Mat &im, images) {
     // ignore file if opencv cannot read it
-    // (it is not image file, e.g. .txt, .DS_Store)
     if (im.data) {
       ret.push_back(im);
     }
   }
   return ret;
 }
+
+SliceReader::SliceReader(const std::string &dir_path, int window)
+    : fnames_(FileLoader::ListImageFiles(dir_path)), window_(std::max(1, window)),
+      begin_(0), next_(0), width_(0), height_(0), depth_(CV_8U) {
+  fill();
+  if (!buffer_.empty()) {
+    width_ = buffer_[0].cols;
+    height_ = buffer_[0].rows;
+    depth_ = buffer_[0].depth();
+  }
+}
+
+void SliceReader::fill() {
+  buffer_.clear();
+  begin_ = next_;
+  buffer_.resize(std::min(window_, (int)fnames_.size() - begin_));
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < (int)buffer_.size(); ++i) {
+    buffer_[i] = cv::imread(fnames_[begin_ + i], cv::IMREAD_ANYDEPTH /* grayscale, 8/16-bit or float */);
+  }
+  for (int i = 0; i < (int)buffer_.size(); ++i) {
+    CHECK(buffer_[i].data) << "cannot decode " << fnames_[begin_ + i];
+  }
+}
+
+bool SliceReader::Next(cv::Mat &image) {
+  if (next_ >= NumSlices())
+    return false;
+  if (next_ - begin_ >= (int)buffer_.size())
+    fill();
+  image = buffer_[next_ - begin_];
+  ++next_;
+  return true;
+}
 } // namespace sigen
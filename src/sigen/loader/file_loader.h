@@ -1,11 +1,43 @@
 #pragma once
 #include "sigen/common/image_sequence.h"
+#include <boost/utility.hpp>
 #include <string>
 #include <vector>
 namespace sigen {
 class FileLoader {
 public:
+  // Image files in specified directory, sorted by file name.
+  // Other files (e.g. .txt, .DS_Store) are skipped by extension or magic
+  // bytes without decoding them.
+  static std::vector<std::string> ListImageFiles(const std::string &dir_path);
   // load image files from specified directory
+  // (slices are decoded in parallel, see SetNumThreads)
   ImageSequence Load(const std::string &dir_path);
 };
+
+// Yields the slices of a directory one at a time (see FileLoader).
+// Slices are decoded `window` at a time in parallel, so at most `window`
+// decoded slices exist at once.
+// Unlike FileLoader::Load, a listed file that cannot be decoded is an error,
+// because the number of slices is fixed up front.
+class SliceReader : boost::noncopyable {
+  std::vector<std::string> fnames_;
+  int window_;
+  ImageSequence buffer_;
+  int begin_; // index of buffer_[0] in fnames_
+  int next_;  // index of the next slice in fnames_
+  int width_, height_, depth_;
+  void fill();
+
+public:
+  SliceReader(const std::string &dir_path, int window);
+  int NumSlices() const { return fnames_.size(); }
+  // size of the first slice (0 if there is none)
+  int Width() const { return width_; }
+  int Height() const { return height_; }
+  // depth (CV_8U, CV_16U or CV_32F) of the first slice
+  int Depth() const { return depth_; }
+  // false after the last slice; `image` is valid until the window moves
+  bool Next(cv::Mat &image);
+};
 }
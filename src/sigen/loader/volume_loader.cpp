@@ -0,0 +1,268 @@
+#include "sigen/loader/volume_loader.h"
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <cctype>
+#include <cstring>
+#include <glog/logging.h>
+#include <sstream>
+#include <stdint.h>
+
+namespace sigen {
+static std::string lowerExtension(const std::string &path) {
+  std::string ext = boost::filesystem::path(path).extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+  return ext;
+}
+
+static bool isLittleEndianHost() {
+  const uint16_t one = 1;
+  return *(const unsigned char *)&one == 1;
+}
+
+static int depthOfUnit(const int unit, const bool is_float) {
+  if (is_float) {
+    CHECK_EQ(4, unit) << "unsupported float voxels";
+    return CV_32F;
+  }
+  switch (unit) {
+  case 1:
+    return CV_8U;
+  case 2:
+    return CV_16U;
+  default:
+    LOG(FATAL) << "unsupported voxel size: " << unit;
+  }
+  return -1;
+}
+
+bool MappedVolume::IsVolumeFile(const std::string &path) {
+  const std::string ext = lowerExtension(path);
+  return ext == ".v3draw" || ext == ".raw" || ext == ".nrrd" || ext == ".tif" || ext == ".tiff";
+}
+
+MappedVolume::MappedVolume(const std::string &path)
+    : file_(path.c_str(), boost::interprocess::read_only),
+      region_(file_, boost::interprocess::read_only),
+      x_(0), y_(0), z_(0), channels_(0), depth_(CV_8U) {
+  const std::string ext = lowerExtension(path);
+  if (ext == ".v3draw" || ext == ".raw") {
+    loadV3draw(path);
+  } else if (ext == ".nrrd") {
+    loadNrrd(path);
+  } else if (ext == ".tif" || ext == ".tiff") {
+    loadTiff(path);
+  } else {
+    LOG(FATAL) << "unknown volume format: " << path;
+  }
+}
+
+// x fastest, then y, z and c, starting at `offset`
+void MappedVolume::setPlanar(size_t offset, int unit) {
+  const size_t slice = (size_t)x_ * y_ * unit;
+  CHECK_LE(offset + slice * z_ * channels_, size()) << "truncated volume";
+  for (int i = 0; i < z_ * channels_; ++i) {
+    slices_.push_back(offset + slice * i);
+    steps_.push_back((size_t)x_ * unit);
+  }
+}
+
+// "raw_image_stack_by_hpeng", endianness ('B' or 'L'), int16 unit bytes,
+// then 4 sizes (x, y, z, c) as int32 (or int16 in old files)
+void MappedVolume::loadV3draw(const std::string &path) {
+  static const char kMagic[] = "raw_image_stack_by_hpeng";
+  const size_t magic_len = sizeof(kMagic) - 1;
+  CHECK_GE(size(), magic_len + 3 + 8) << path << " is not a v3draw file";
+  CHECK(std::memcmp(data(), kMagic, magic_len) == 0) << path << " is not a v3draw file";
+  const char endian = data()[magic_len];
+  CHECK(endian == 'B' || endian == 'L') << path << " is not a v3draw file";
+  const bool little = endian == 'L';
+  int16_t unit;
+  std::memcpy(&unit, data() + magic_len + 1, 2);
+  CHECK(unit == 1 || little == isLittleEndianHost()) << "byte order of " << path << " is not native";
+  const unsigned char *p = data() + magic_len + 3;
+  int32_t sz32[4];
+  int16_t sz16[4];
+  std::memcpy(sz32, p, sizeof(sz32));
+  std::memcpy(sz16, p, sizeof(sz16));
+  const size_t n32 = (size_t)sz32[0] * sz32[1] * sz32[2] * sz32[3] * unit;
+  size_t offset;
+  if (size() >= magic_len + 3 + sizeof(sz32) && size() - (magic_len + 3 + sizeof(sz32)) == n32) {
+    x_ = sz32[0], y_ = sz32[1], z_ = sz32[2], channels_ = sz32[3];
+    offset = magic_len + 3 + sizeof(sz32);
+  } else {
+    x_ = sz16[0], y_ = sz16[1], z_ = sz16[2], channels_ = sz16[3];
+    offset = magic_len + 3 + sizeof(sz16);
+  }
+  // v3draw stores floats as 4-byte units
+  depth_ = depthOfUnit(unit, unit == 4);
+  setPlanar(offset, unit);
+}
+
+// attached header: "NRRD000X" line, "field: value" lines, then an empty line
+void MappedVolume::loadNrrd(const std::string &path) {
+  const char *begin = (const char *)data();
+  const char *end = begin + size();
+  CHECK(size() >= 4 && std::memcmp(begin, "NRRD", 4) == 0) << path << " is not a NRRD file";
+  const char *p = begin;
+  std::string type, encoding = "raw", endian, sizes;
+  int dimension = 0;
+  while (true) {
+    const char *eol = std::find(p, end, '\n');
+    CHECK(eol != end) << "truncated NRRD header: " << path;
+    std::string line(p, eol);
+    p = eol + 1;
+    if (!line.empty() && line[line.size() - 1] == '\r')
+      line.erase(line.size() - 1);
+    if (line.empty())
+      break;
+    if (line[0] == '#')
+      continue;
+    const size_t colon = line.find(": ");
+    if (colon == std::string::npos)
+      continue;
+    const std::string key = line.substr(0, colon);
+    const std::string value = line.substr(colon + 2);
+    if (key == "type")
+      type = value;
+    else if (key == "dimension")
+      dimension = std::atoi(value.c_str());
+    else if (key == "sizes")
+      sizes = value;
+    else if (key == "encoding")
+      encoding = value;
+    else if (key == "endian")
+      endian = value;
+    else if (key == "data file" || key == "datafile")
+      LOG(FATAL) << "detached NRRD data is not supported: " << path;
+    else if (key == "byte skip" || key == "byteskip" || key == "line skip" || key == "lineskip")
+      CHECK_EQ(0, std::atoi(value.c_str())) << key << " is not supported: " << path;
+  }
+  CHECK(encoding == "raw") << "NRRD encoding " << encoding << " is not supported: " << path;
+  int unit;
+  bool is_float = false;
+  if (type == "uchar" || type == "unsigned char" || type == "uint8" || type == "uint8_t") {
+    unit = 1;
+  } else if (type == "ushort" || type == "unsigned short" || type == "unsigned short int" ||
+             type == "uint16" || type == "uint16_t") {
+    unit = 2;
+  } else if (type == "float") {
+    unit = 4;
+    is_float = true;
+  } else {
+    LOG(FATAL) << "NRRD type " << type << " is not supported: " << path;
+    return;
+  }
+  CHECK(unit == 1 || endian.empty() || (endian == "little") == isLittleEndianHost())
+      << "byte order of " << path << " is not native";
+  CHECK(dimension == 3 || dimension == 4) << "NRRD dimension must be 3 or 4: " << path;
+  std::istringstream ss(sizes);
+  int sz[4] = {1, 1, 1, 1};
+  for (int i = 0; i < dimension; ++i) {
+    ss >> sz[i];
+  }
+  x_ = sz[0], y_ = sz[1], z_ = sz[2], channels_ = sz[3];
+  depth_ = depthOfUnit(unit, is_float);
+  setPlanar(p - begin, unit);
+}
+
+namespace {
+// reads classic (32-bit offset) TIFF structures of either byte order
+class TiffReader {
+  const unsigned char *data_;
+  size_t size_;
+  bool little_;
+
+public:
+  TiffReader(const unsigned char *data, size_t size, bool little)
+      : data_(data), size_(size), little_(little) {}
+  uint32_t Read(size_t offset, int bytes) const {
+    CHECK_LE(offset + bytes, size_) << "truncated TIFF";
+    uint32_t v = 0;
+    for (int i = 0; i < bytes; ++i) {
+      const uint32_t b = data_[offset + i];
+      v |= little_ ? b << (8 * i) : b << (8 * (bytes - 1 - i));
+    }
+    return v;
+  }
+  // value i of an IFD entry (type 3: SHORT, 4: LONG)
+  uint32_t Value(size_t entry, uint32_t i) const {
+    const int type = Read(entry + 2, 2);
+    const uint32_t count = Read(entry + 4, 4);
+    const int bytes = type == 3 ? 2 : 4;
+    CHECK_LT(i, count);
+    const size_t base = count * bytes <= 4 ? entry + 8 : Read(entry + 8, 4);
+    return Read(base + i * bytes, bytes);
+  }
+  uint32_t Count(size_t entry) const { return Read(entry + 4, 4); }
+};
+} // namespace
+
+// every page must be an uncompressed single-channel BlackIsZero image of the
+// same size, with its strips stored back to back
+void MappedVolume::loadTiff(const std::string &path) {
+  CHECK_GE(size(), 8u) << path << " is not a TIFF file";
+  const bool little = data()[0] == 'I';
+  const TiffReader r(data(), size(), little);
+  CHECK(((data()[0] == 'I' && data()[1] == 'I') || (data()[0] == 'M' && data()[1] == 'M')) &&
+        r.Read(2, 2) == 42)
+      << path << " is not a classic TIFF file";
+  channels_ = 1;
+  int unit = 0;
+  for (uint32_t ifd = r.Read(4, 4); ifd != 0; ifd = r.Read(ifd + 2 + 12 * r.Read(ifd, 2), 4)) {
+    int width = 0, height = 0, bits = 8, compression = 1, samples = 1, format = 1, photometric = 1;
+    size_t strips = 0, counts = 0;
+    const int n = r.Read(ifd, 2);
+    for (int i = 0; i < n; ++i) {
+      const size_t e = ifd + 2 + 12 * i;
+      switch (r.Read(e, 2)) {
+      case 256: width = r.Value(e, 0); break;
+      case 257: height = r.Value(e, 0); break;
+      case 258: bits = r.Value(e, 0); break;
+      case 259: compression = r.Value(e, 0); break;
+      case 262: photometric = r.Value(e, 0); break;
+      case 273: strips = e; break;
+      case 277: samples = r.Value(e, 0); break;
+      case 279: counts = e; break;
+      case 339: format = r.Value(e, 0); break;
+      }
+    }
+    CHECK_EQ(1, compression) << "compressed TIFF is not supported: " << path;
+    CHECK_EQ(1, samples) << "TIFF must be grayscale: " << path;
+    // WhiteIsZero (0) would be binarized with inverted intensity
+    CHECK_EQ(1, photometric) << "TIFF must be BlackIsZero grayscale (PhotometricInterpretation 1): " << path;
+    CHECK(strips != 0 && counts != 0) << "TIFF without strips: " << path;
+    CHECK(bits == 8 || bits == 16 || (bits == 32 && format == 3)) << "unsupported TIFF pixels: " << path;
+    CHECK(bits == 8 || little == isLittleEndianHost()) << "byte order of " << path << " is not native";
+    if (z_ == 0) {
+      x_ = width, y_ = height, unit = bits / 8;
+      depth_ = depthOfUnit(unit, format == 3);
+    }
+    CHECK(x_ == width && y_ == height && unit == bits / 8) << "TIFF pages differ in size: " << path;
+    // strips must be contiguous, so that the page is one block
+    const size_t first = r.Value(strips, 0);
+    size_t next = first;
+    for (uint32_t i = 0; i < r.Count(strips); ++i) {
+      CHECK_EQ(next, (size_t)r.Value(strips, i)) << "TIFF strips are not contiguous: " << path;
+      next += r.Value(counts, i);
+    }
+    CHECK_LE(first + (size_t)x_ * y_ * unit, size()) << "truncated TIFF: " << path;
+    slices_.push_back(first);
+    steps_.push_back((size_t)x_ * unit);
+    ++z_;
+  }
+}
+
+cv::Mat MappedVolume::Slice(int z, int channel) const {
+  CHECK(0 <= z && z < z_ && 0 <= channel && channel < channels_);
+  const int i = channel * z_ + z;
+  return cv::Mat(y_, x_, CV_MAKETYPE(depth_, 1), (void *)(data() + slices_[i]), steps_[i]);
+}
+
+ImageSequence MappedVolume::Slices(int channel) const {
+  ImageSequence ret;
+  for (int z = 0; z < z_; ++z) {
+    ret.push_back(Slice(z, channel));
+  }
+  return ret;
+}
+} // namespace sigen
@@ -0,0 +1,46 @@
+#pragma once
+#include "sigen/common/image_sequence.h"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/utility.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+namespace sigen {
+// A single-file uncompressed volume, mapped read-only.
+// Supported formats (by extension):
+//   .v3draw / .raw  Vaa3D raw image stack (8-bit, 16-bit or float)
+//   .nrrd           NRRD with attached raw data, x y z (c) axes
+//   .tif / .tiff    multi-page TIFF, uncompressed grayscale pages
+// Slices are cv::Mat headers over the mapping, so nothing is read until a
+// slice is touched. They are valid while the MappedVolume lives, and must not
+// be written. Multi-byte voxels must be in native byte order.
+class MappedVolume : boost::noncopyable {
+  boost::interprocess::file_mapping file_;
+  boost::interprocess::mapped_region region_;
+  int x_, y_, z_, channels_;
+  int depth_;                  // CV_8U, CV_16U or CV_32F
+  std::vector<size_t> slices_; // offset of slice (z, c) at c * z_ + z
+  std::vector<size_t> steps_;  // bytes per row of each slice
+
+  const unsigned char *data() const { return (const unsigned char *)region_.get_address(); }
+  size_t size() const { return region_.get_size(); }
+  void loadV3draw(const std::string &path);
+  void loadNrrd(const std::string &path);
+  void loadTiff(const std::string &path);
+  void setPlanar(size_t offset, int unit);
+
+public:
+  explicit MappedVolume(const std::string &path);
+  int Width() const { return x_; }
+  int Height() const { return y_; }
+  int NumSlices() const { return z_; }
+  int NumChannels() const { return channels_; }
+  int Depth() const { return depth_; }
+  cv::Mat Slice(int z, int channel) const;
+  // every slice of `channel`, without copying
+  ImageSequence Slices(int channel) const;
+  // true if `path` has an extension of the formats above
+  static bool IsVolumeFile(const std::string &path);
+};
+} // namespace sigen
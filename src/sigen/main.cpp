@@ -1,12 +1,24 @@
 #include "sigen/binarizer/binarizer.h"
 #include "sigen/builder/builder.h"
+#include "sigen/common/parallel.h"
 #include "sigen/extractor/extractor.h"
+#include "sigen/extractor/prefilter.h"
+#include "sigen/extractor/threshold_sweep.h"
+#include "sigen/extractor/tiled_extractor.h"
+#include "sigen/loader/cube_cache.h"
 #include "sigen/loader/file_loader.h"
+#include "sigen/loader/volume_loader.h"
 #include "sigen/toolbox/toolbox.h"
 #include "sigen/writer/fileutils.h"
 #include "sigen/writer/swc_writer.h"
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <cmath>
+#include <functional>
 #include <glog/logging.h>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -27,7 +39,7 @@ void initGlog(const char *program_name) {
 
 cmdline::parser parse_args(int argc, char *argv[]) {
   cmdline::parser a;
-  a.add<std::string>("input", 'i', "input image directory");
+  a.add<std::string>("input", 'i', "input image directory, or volume file (.v3draw, .nrrd, multi-page .tif)");
   a.add<std::string>("output", 'o', "output filename");
   a.add<double>("scale-xy", '\0', "", false, 1.0);
   a.add<double>("scale-z", '\0', "", false, 1.0);
@@ -35,32 +47,189 @@ cmdline::parser parse_args(int argc, char *argv[]) {
   a.add<int>("vt", '\0', "volume threshold", false, 0);
   a.add<int>("clipping", '\0', "clipping level", false, 0);
   a.add<int>("smoothing", '\0', "smoothing level", false, 0);
-  a.add<int>("bin_thresh", '\0', "binarization threshold", false, 127);
+  a.add<double>("bin_thresh", '\0', "binarization threshold, on the 8-bit scale (16-bit voxels v are compared as v >> 8) unless --raw_thresh", false, 127);
+  a.add("raw_thresh", '\0', "compare --bin_thresh and --sweep thresholds with the voxel values of 16-bit inputs");
+  a.add<int>("min_voxels", '\0', "drop connected components of fewer voxels before extraction (not with --tile)", false, 0);
+  a.add<int>("threads", 'j', "number of threads (0: all cores)", false, 0);
+  a.add<std::string>("layout", '\0', "layout of the binarized volume (flat, rle for sparse volumes, bricked for mostly empty volumes)",
+                     false, "flat", cmdline::oneof<std::string>("flat", "rle", "bricked"));
+  a.add<std::string>("mmap", '\0', "binarize into a memory-mapped cube file at this path (flat layout only)", false, "");
+  a.add<int>("channel", '\0', "channel of a volume file (from 0)", false, 0);
+  a.add<std::string>("cache", '\0', "cache binarized cubes in this directory, keyed by the input files and bin_thresh", false, "");
+  a.add("stream", '\0', "binarize slices as they are decoded, without holding the whole image sequence (image directories only, not with --sweep or --cache)");
+  a.add<int>("tile", '\0', "with --stream, extract z-slabs of this many slices one at a time and stitch them (0: whole volume; not with --cache, --sweep or --min_voxels)", false, 0);
+  a.add<std::string>("sweep", '\0', "comma-separated binarization thresholds; prints component statistics of each", false, "");
+  a.add("sweep_swc", '\0', "with --sweep, also write the reconstruction of each threshold into <output>/<threshold>");
   a.parse_check(argc, argv);
   return a;
 }
 
-int main(int argc, char *argv[]) {
-  initGlog(argv[0]);
+// Thresholds are on the 8-bit scale of the original loader, which decoded a
+// 16-bit slice as v >> 8: (v >> 8) > t exactly when v > (floor(t) + 1) * 256 - 1.
+// 8-bit and float voxels, and --raw_thresh, compare the values themselves.
+double scaledThresh(const double thresh, const int depth, const cmdline::parser &args) {
+  if (depth != CV_16U || args.exist("raw_thresh"))
+    return thresh;
+  return (std::floor(thresh) + 1) * 256 - 1;
+}
 
-  cmdline::parser args = parse_args(argc, argv);
+// The extractor takes over `cube` and releases it on return.
+// `filtered` skips the pre-filter of an already filtered cube.
+// Clusters are summarized for reconstruct(), so their points are not kept.
+template <class Cube>
+sigen::ClusterStore extractClusters(Cube &cube, const cmdline::parser &args, const bool filtered = false) {
+  sigen::Extractor ext(boost::move(cube));
+  ext.filtered_ = filtered;
+  ext.summarize_ = true;
+  ext.scale_xy_ = args.get<double>("scale-xy");
+  ext.scale_z_ = args.get<double>("scale-z");
+  ext.min_component_voxels_ = args.get<int>("min_voxels");
+  return ext.Extract();
+}
 
-  sigen::FileLoader loader;
-  sigen::ImageSequence is = loader.Load(args.get<std::string>("input"));
-  LOG(INFO) << "load (done)";
+// binarizes the slices of `reader` into `cube` as soon as they are decoded
+template <class Cube>
+void binarizeStream(sigen::SliceReader &reader, const double thresh, Cube &cube) {
+  sigen::Binarizer bin;
+  cv::Mat image;
+  for (int z = 0; reader.Next(image); ++z) {
+    bin.BinarizeSlice(image, z, thresh, cube);
+  }
+}
 
-  const int bin_thresh = args.get<int>("bin_thresh");
+// A flat cube is also pre-filtered as the last stage of binarization:
+// slice z - 1 is filtered as soon as slice z is written.
+void binarizeStream(sigen::SliceReader &reader, const double thresh, sigen::BinaryCube &cube) {
   sigen::Binarizer bin;
-  sigen::BinaryCube cube = bin.Binarize(is, bin_thresh);
-  is.clear();
-  LOG(INFO) << "binarize (done)";
+  cv::Mat image;
+  for (int z = 0; reader.Next(image); ++z) {
+    bin.BinarizeSlice(image, z, thresh, cube);
+    if (z > 0)
+      sigen::PrefilterSlice(cube, z - 1);
+  }
+  if (cube.z_ > 0)
+    sigen::PrefilterSlice(cube, cube.z_ - 1);
+}
 
-  sigen::Extractor ext(cube);
-  std::vector<sigen::ClusterPtr> clusters = ext.Extract();
-  cube.Clear();
-  LOG(INFO) << "extract (done)";
+// Streaming counterpart of load + binarize + extract in main: only a window
+// of decoded slices (one per thread) exists at once.
+sigen::ClusterStore streamClusters(const cmdline::parser &args) {
+  sigen::SliceReader reader(args.get<std::string>("input"), sigen::GetNumThreads());
+  CHECK_GT(reader.NumSlices(), 0);
+  const int x = reader.Width(), y = reader.Height(), z = reader.NumSlices();
+  const double bin_thresh = scaledThresh(args.get<double>("bin_thresh"), reader.Depth(), args);
+  const std::string layout = args.get<std::string>("layout");
+  if (layout == "rle") {
+    sigen::RunLengthCube cube(x, y, z);
+    binarizeStream(reader, bin_thresh, cube);
+    LOG(INFO) << "load and binarize (done)";
+    return extractClusters(cube, args);
+  } else if (layout == "bricked") {
+    sigen::BrickedCube cube(x, y, z);
+    binarizeStream(reader, bin_thresh, cube);
+    LOG(INFO) << "load and binarize (done)";
+    return extractClusters(cube, args);
+  } else if (!args.get<std::string>("mmap").empty()) {
+    sigen::BinaryCube cube = sigen::BinaryCube::CreateMapped(args.get<std::string>("mmap"), x, y, z);
+    binarizeStream(reader, bin_thresh, cube);
+    cube.Flush();
+    LOG(INFO) << "load, binarize and filter (done)";
+    return extractClusters(cube, args, true);
+  } else {
+    sigen::BinaryCube cube(x, y, z);
+    binarizeStream(reader, bin_thresh, cube);
+    LOG(INFO) << "load, binarize and filter (done)";
+    return extractClusters(cube, args, true);
+  }
+}
 
-  sigen::Builder builder(clusters, args.get<double>("scale-xy"), args.get<double>("scale-z"));
+// Streams the slices into one tile at a time (see TiledExtractor), so only
+// a tile of the binarized volume exists at once. The slices shared with the
+// next tile (its lower halo) are kept decoded.
+sigen::ClusterStore tiledClusters(const cmdline::parser &args) {
+  sigen::SliceReader reader(args.get<std::string>("input"), sigen::GetNumThreads());
+  CHECK_GT(reader.NumSlices(), 0);
+  const int x = reader.Width(), y = reader.Height(), z = reader.NumSlices();
+  const double bin_thresh = scaledThresh(args.get<double>("bin_thresh"), reader.Depth(), args);
+  sigen::TiledExtractor tiles(x, y, z, args.get<int>("tile"));
+  tiles.scale_xy_ = args.get<double>("scale-xy");
+  tiles.scale_z_ = args.get<double>("scale-z");
+  sigen::Binarizer bin;
+  std::vector<cv::Mat> kept; // slices [kept_begin, ZEnd(t - 1))
+  int kept_begin = 0;
+  cv::Mat image;
+  for (int t = 0; t < tiles.NumTiles(); ++t) {
+    const int begin = tiles.ZBegin(t), end = tiles.ZEnd(t);
+    const int next_begin = t + 1 < tiles.NumTiles() ? tiles.ZBegin(t + 1) : end;
+    sigen::BinaryCube cube(x, y, end - begin);
+    std::vector<cv::Mat> next;
+    for (int k = begin; k < end; ++k) {
+      if (k < kept_begin + (int)kept.size())
+        image = kept[k - kept_begin];
+      else
+        CHECK(reader.Next(image));
+      bin.BinarizeSlice(image, k - begin, bin_thresh, cube);
+      if (k >= next_begin)
+        next.push_back(image.clone());
+    }
+    kept.swap(next);
+    kept_begin = next_begin;
+    tiles.ExtractTile(t, boost::move(cube));
+    LOG(INFO) << "extract tile " << t + 1 << "/" << tiles.NumTiles();
+  }
+  return tiles.Stitch();
+}
+
+// extracts from a binarized cube in the requested layout
+sigen::ClusterStore extractClustersAs(sigen::BinaryCube &cube, const cmdline::parser &args, const bool filtered) {
+  const std::string layout = args.get<std::string>("layout");
+  if (layout == "rle") {
+    sigen::RunLengthCube runs(cube);
+    cube.Clear();
+    return extractClusters(runs, args, filtered);
+  } else if (layout == "bricked") {
+    sigen::BrickedCube bricks(cube);
+    cube.Clear();
+    return extractClusters(bricks, args, filtered);
+  } else {
+    return extractClusters(cube, args, filtered);
+  }
+}
+
+// Maps the cached cube of the input if it is up to date, or binarizes the
+// input (streaming slices) into a new cache entry. Entries are pre-filtered
+// before they are committed, so a hit skips the filter as well.
+sigen::ClusterStore cachedClusters(const cmdline::parser &args, const bool is_volume) {
+  const std::string input = args.get<std::string>("input");
+  const int channel = is_volume ? args.get<int>("channel") : 0;
+  sigen::CubeCache cache(args.get<std::string>("cache"));
+  const std::string key = sigen::CubeCache::Key(input, args.get<double>("bin_thresh"), args.exist("raw_thresh"), channel);
+  sigen::BinaryCube cube(0, 0, 0);
+  if (cache.Find(key, cube)) {
+    LOG(INFO) << "cache hit";
+  } else if (is_volume) {
+    sigen::MappedVolume volume(input);
+    cube = cache.Create(key, volume.Width(), volume.Height(), volume.NumSlices());
+    sigen::Binarizer bin;
+    bin.Binarize(volume.Slices(channel), scaledThresh(args.get<double>("bin_thresh"), volume.Depth(), args), cube);
+    sigen::Prefilter(cube);
+    cache.Commit(key, cube);
+    LOG(INFO) << "binarize and filter into cache (done)";
+  } else {
+    sigen::SliceReader reader(input, sigen::GetNumThreads());
+    CHECK_GT(reader.NumSlices(), 0);
+    cube = cache.Create(key, reader.Width(), reader.Height(), reader.NumSlices());
+    binarizeStream(reader, scaledThresh(args.get<double>("bin_thresh"), reader.Depth(), args), cube);
+    cache.Commit(key, cube);
+    LOG(INFO) << "load, binarize and filter into cache (done)";
+  }
+  return extractClustersAs(cube, args, true);
+}
+
+// builds, post-processes and writes the neurons of `clusters` (taken over)
+void reconstruct(sigen::ClusterStore &clusters,
+                 const cmdline::parser &args, const std::string &output_dir) {
+  sigen::Builder builder(boost::move(clusters), args.get<double>("scale-xy"), args.get<double>("scale-z"));
   std::vector<sigen::Neuron> ns = builder.Build();
   LOG(INFO) << "build (done)";
 
@@ -85,10 +254,156 @@ int main(int argc, char *argv[]) {
 
   sigen::SwcWriter writer;
   for (int i = 0; i < (int)ns.size(); ++i) {
-    std::string filename =
-        args.get<std::string>("output") + "/" + std::to_string(i) + ".swc";
+    std::string filename = output_dir + "/" + std::to_string(i) + ".swc";
     filename = sigen::FileUtils::AddExtension(filename, ".swc");
     writer.Write(filename.c_str(), ns[i]);
   }
   LOG(INFO) << "write (done)";
 }
+
+std::vector<double> parse_thresholds(const std::string &list) {
+  std::vector<double> ret;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    ret.push_back(std::stod(item));
+  }
+  return ret;
+}
+
+// Sorts the voxels once and reports every threshold of --sweep, instead of
+// rerunning binarize and extract per threshold.
+void sweep(const sigen::ImageSequence &is, const cmdline::parser &args) {
+  const std::vector<double> thresholds = parse_thresholds(args.get<std::string>("sweep"));
+  CHECK(!thresholds.empty());
+  CHECK(!is.empty());
+  const int depth = is[0].depth();
+  sigen::ThresholdSweep sw(is[0].cols, is[0].rows, is.size(),
+                           scaledThresh(*std::min_element(thresholds.begin(), thresholds.end()), depth, args),
+                           /* inclusive = */ false);
+  for (int z = 0; z < (int)is.size(); ++z) {
+    const cv::Mat &image = is[z];
+    CHECK_EQ(is[0].cols, image.cols);
+    CHECK_EQ(is[0].rows, image.rows);
+    for (int y = 0; y < image.rows; ++y) {
+      switch (image.depth()) {
+      case CV_8U:
+        sw.AddRow(y, z, image.ptr<uint8_t>(y), 1);
+        break;
+      case CV_16U:
+        sw.AddRow(y, z, image.ptr<uint16_t>(y), 1);
+        break;
+      case CV_32F:
+        sw.AddRow(y, z, image.ptr<float>(y), 1);
+        break;
+      default:
+        LOG(FATAL) << "unsupported depth: " << image.depth();
+      }
+    }
+  }
+  sw.SetUp();
+  LOG(INFO) << "sort (done)";
+
+  std::vector<double> sorted = thresholds;
+  std::sort(sorted.begin(), sorted.end(), std::greater<double>());
+  std::cout << "thresh,components,voxels,largest" << std::endl;
+  for (int i = 0; i < (int)sorted.size(); ++i) {
+    // scaledThresh keeps the order of thresholds
+    sw.Lower(scaledThresh(sorted[i], depth, args));
+    const sigen::SweepStats &stats = sw.Stats();
+    std::cout << sorted[i] << "," << stats.num_components_ << ","
+              << stats.num_voxels_ << "," << stats.largest_component_ << std::endl;
+    if (args.exist("sweep_swc")) {
+      std::ostringstream dir;
+      dir << args.get<std::string>("output") << "/" << sorted[i];
+      boost::filesystem::create_directories(dir.str());
+      sigen::RunLengthCube cube = sw.Foreground();
+      sigen::ClusterStore clusters = extractClusters(cube, args);
+      reconstruct(clusters, args, dir.str());
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  initGlog(argv[0]);
+
+  cmdline::parser args = parse_args(argc, argv);
+  sigen::SetNumThreads(args.get<int>("threads"));
+
+  const std::string input = args.get<std::string>("input");
+  const bool is_volume = boost::filesystem::is_regular_file(input);
+  CHECK(!is_volume || sigen::MappedVolume::IsVolumeFile(input))
+      << "unsupported volume file: " << input << " (.v3draw, .raw, .nrrd, .tif or .tiff)";
+  const bool sweeping = !args.get<std::string>("sweep").empty(), caching = !args.get<std::string>("cache").empty();
+  if (args.exist("stream") && (is_volume || sweeping || caching))
+    LOG(WARNING) << "--stream is ignored for volume files and with --sweep or --cache";
+  // a tile bounds the memory, so falling back to the whole volume is an error
+  CHECK(args.get<int>("tile") == 0 || (args.exist("stream") && !is_volume && !sweeping && !caching))
+      << "--tile needs --stream on an image directory, without --sweep or --cache";
+  if (args.get<int>("tile") > 0 && args.get<int>("min_voxels") > 0)
+    LOG(WARNING) << "--min_voxels is ignored with --tile: components span tiles";
+  if (caching && !sweeping) {
+    sigen::ClusterStore clusters = cachedClusters(args, is_volume);
+    LOG(INFO) << "extract (done)";
+    reconstruct(clusters, args, args.get<std::string>("output"));
+    return 0;
+  }
+  if (args.exist("stream") && !is_volume && !sweeping) {
+    sigen::ClusterStore clusters = args.get<int>("tile") > 0 ? tiledClusters(args) : streamClusters(args);
+    LOG(INFO) << "extract (done)";
+    reconstruct(clusters, args, args.get<std::string>("output"));
+    return 0;
+  }
+
+  // slices of a volume file are views of its mapping, read on demand
+  boost::scoped_ptr<sigen::MappedVolume> volume;
+  sigen::ImageSequence is;
+  if (is_volume) {
+    volume.reset(new sigen::MappedVolume(input));
+    is = volume->Slices(args.get<int>("channel"));
+    LOG(INFO) << "map (done)";
+  } else {
+    sigen::FileLoader loader;
+    is = loader.Load(input);
+    LOG(INFO) << "load (done)";
+  }
+
+  if (!args.get<std::string>("sweep").empty()) {
+    sweep(is, args);
+    return 0;
+  }
+
+  CHECK(!is.empty());
+  const double bin_thresh = scaledThresh(args.get<double>("bin_thresh"), is[0].depth(), args);
+  sigen::Binarizer bin;
+  sigen::ClusterStore clusters;
+  const std::string layout = args.get<std::string>("layout");
+  if (layout == "rle") {
+    sigen::RunLengthCube cube = bin.BinarizeRunLength(is, bin_thresh);
+    is.clear();
+    LOG(INFO) << "binarize (done)";
+    clusters = extractClusters(cube, args);
+  } else if (layout == "bricked") {
+    sigen::BrickedCube cube = bin.BinarizeBricked(is, bin_thresh);
+    is.clear();
+    LOG(INFO) << "binarize (done)";
+    clusters = extractClusters(cube, args);
+  } else if (!args.get<std::string>("mmap").empty()) {
+    CHECK(!is.empty());
+    sigen::BinaryCube cube = sigen::BinaryCube::CreateMapped(
+        args.get<std::string>("mmap"), is[0].cols, is[0].rows, is.size());
+    bin.Binarize(is, bin_thresh, cube);
+    is.clear();
+    cube.Flush();
+    LOG(INFO) << "binarize (done)";
+    clusters = extractClusters(cube, args);
+  } else {
+    sigen::BinaryCube cube = bin.Binarize(is, bin_thresh);
+    is.clear();
+    LOG(INFO) << "binarize (done)";
+    clusters = extractClusters(cube, args);
+  }
+  LOG(INFO) << "extract (done)";
+
+  reconstruct(clusters, args, args.get<std::string>("output"));
+}
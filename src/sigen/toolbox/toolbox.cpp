@@ -198,7 +198,7 @@ std::vector<Neuron> Smoothing(const std::vector<Neuron> &input, const int n_iter
   for (int iter = 0; iter < n_iter; ++iter) {
     std::map<int, PointAndRadius> next_value;
     for (int i = 0; i < (int)forest.size(); ++i) {
-      BOOST_FOREACH (NeuronNodePtr node, forest[i].storage_) {
+      BOOST_FOREACH (const NeuronNodePtr &node, forest[i].storage_) {
         std::vector<double> gx, gy, gz, radius;
         gx.push_back(node->gx_);
         gy.push_back(node->gy_);
@@ -217,7 +217,7 @@ std::vector<Neuron> Smoothing(const std::vector<Neuron> &input, const int n_iter
       }
     }
     for (int i = 0; i < (int)forest.size(); ++i) {
-      BOOST_FOREACH (NeuronNodePtr node, forest[i].storage_) {
+      BOOST_FOREACH (const NeuronNodePtr &node, forest[i].storage_) {
         PointAndRadius next_node = next_value[node->id_];
         node->setCoord(next_node.gx_, next_node.gy_, next_node.gz_);
         node->radius_ = next_node.radius_;
@@ -1,5 +1,9 @@
 #include "sigen/common/binary_cube.h"
+#include <cstdio>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
 TEST(BinaryCube, init) {
   sigen::BinaryCube cube(2, 3, 4);
   EXPECT_EQ(2, cube.x_);
@@ -11,19 +15,82 @@ TEST(BinaryCube, read_write) {
   for (int i = 0; i < 2; ++i) {
     for (int j = 0; j < 3; ++j) {
       for (int k = 0; k < 4; ++k) {
-        EXPECT_FALSE(cube[i][j][k]);
+        EXPECT_FALSE(cube.Get(i, j, k));
       }
     }
   }
-  cube[1][2][3] = true;
+  cube.Set(1, 2, 3, true);
   for (int i = 0; i < 2; ++i) {
     for (int j = 0; j < 3; ++j) {
       for (int k = 0; k < 4; ++k) {
         if (i == 1 && j == 2 && k == 3)
-          EXPECT_TRUE(cube[i][j][k]);
+          EXPECT_TRUE(cube.Get(i, j, k));
         else
-          EXPECT_FALSE(cube[i][j][k]);
+          EXPECT_FALSE(cube.Get(i, j, k));
       }
     }
   }
+  cube.Set(1, 2, 3, false);
+  EXPECT_FALSE(cube.Get(1, 2, 3));
+}
+TEST(BinaryCube, row_layout) {
+  sigen::BinaryCube cube(130, 2, 2);
+  EXPECT_EQ(3, cube.WordsPerRow());
+  cube.Set(0, 1, 1, true);
+  cube.Set(64, 1, 1, true);
+  cube.Set(129, 1, 1, true);
+  const uint64_t *row = cube.Row(1, 1);
+  EXPECT_EQ(1u, row[0]);
+  EXPECT_EQ(1u, row[1]);
+  EXPECT_EQ((uint64_t)1 << 1, row[2]);
+  // rows are contiguous and x-fastest
+  EXPECT_EQ(cube.Row(0, 1) + cube.WordsPerRow(), row);
+  EXPECT_EQ(cube.Row(1, 0) + cube.WordsPerRow(), cube.Row(0, 1));
+}
+TEST(BinaryCube, move) {
+  sigen::BinaryCube cube(70, 3, 4);
+  cube.Set(65, 2, 3, true);
+  sigen::BinaryCube moved(boost::move(cube));
+  EXPECT_TRUE(moved.Get(65, 2, 3));
+  EXPECT_EQ(70, moved.x_);
+  EXPECT_EQ(0, cube.x_);
+  sigen::BinaryCube copied = moved;
+  EXPECT_TRUE(copied.Get(65, 2, 3));
+  EXPECT_TRUE(moved.Get(65, 2, 3));
+}
+TEST(BinaryCube, mapped) {
+  const std::string path = "binary_cube_test.cube";
+  {
+    sigen::BinaryCube cube = sigen::BinaryCube::CreateMapped(path, 70, 3, 4);
+    EXPECT_TRUE(cube.IsMapped());
+    EXPECT_FALSE(cube.Get(65, 2, 3));
+    cube.Set(65, 2, 3, true);
+    cube.Flush();
+  }
+  {
+    sigen::BinaryCube cube = sigen::BinaryCube::OpenMapped(path, true);
+    EXPECT_TRUE(cube.IsMapped());
+    EXPECT_EQ(70, cube.x_);
+    EXPECT_EQ(3, cube.y_);
+    EXPECT_EQ(4, cube.z_);
+    EXPECT_TRUE(cube.Get(65, 2, 3));
+    EXPECT_FALSE(cube.Get(64, 2, 3));
+    // copies live in memory
+    sigen::BinaryCube copied = cube;
+    EXPECT_FALSE(copied.IsMapped());
+    EXPECT_TRUE(copied.Get(65, 2, 3));
+    sigen::BinaryCube moved(boost::move(cube));
+    EXPECT_TRUE(moved.IsMapped());
+    EXPECT_FALSE(cube.IsMapped());
+  }
+  std::remove(path.c_str());
+}
+TEST(BinaryCube, mapped_invalid) {
+  const std::string path = "binary_cube_test.txt";
+  {
+    std::ofstream ofs(path.c_str());
+    ofs << "this is not a cube file, but long enough to hold a header..........";
+  }
+  EXPECT_THROW(sigen::BinaryCube::OpenMapped(path, true), std::runtime_error);
+  std::remove(path.c_str());
 }
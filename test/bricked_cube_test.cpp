@@ -0,0 +1,43 @@
+#include "random_cube.h"
+#include "sigen/common/bricked_cube.h"
+#include <gtest/gtest.h>
+using namespace sigen;
+TEST(BrickedCube, init) {
+  BrickedCube cube(9, 8, 17);
+  EXPECT_EQ(9, cube.x_);
+  EXPECT_EQ(8, cube.y_);
+  EXPECT_EQ(17, cube.z_);
+  EXPECT_EQ(2, cube.BricksX());
+  EXPECT_EQ(1, cube.BricksY());
+  EXPECT_EQ(3, cube.BricksZ());
+  EXPECT_EQ(0, cube.CountVoxels());
+}
+TEST(BrickedCube, read_write) {
+  BrickedCube cube(9, 8, 17);
+  cube.Set(8, 7, 16, true);
+  cube.Set(8, 7, 16, true);
+  EXPECT_TRUE(cube.Get(8, 7, 16));
+  EXPECT_FALSE(cube.Get(7, 7, 16));
+  EXPECT_EQ(1, cube.Population(cube.BrickIndex(1, 0, 2)));
+  EXPECT_TRUE(cube.IsEmpty(cube.BrickIndex(0, 0, 2)));
+  EXPECT_FALSE(cube.GetOrFalse(9, 7, 16));
+  cube.Set(8, 7, 16, false);
+  EXPECT_FALSE(cube.Get(8, 7, 16));
+  EXPECT_TRUE(cube.IsEmpty(cube.BrickIndex(1, 0, 2)));
+}
+TEST(BrickedCube, binary_cube) {
+  BinaryCube cube = randomCube(70, 13, 9, 1, 3);
+  BrickedCube bricks(cube);
+  BinaryCube decoded = bricks.ToBinaryCube();
+  long long n = 0;
+  for (int z = 0; z < cube.z_; ++z) {
+    for (int y = 0; y < cube.y_; ++y) {
+      for (int x = 0; x < cube.x_; ++x) {
+        EXPECT_EQ(cube.Get(x, y, z), bricks.Get(x, y, z));
+        EXPECT_EQ(cube.Get(x, y, z), decoded.Get(x, y, z));
+        n += cube.Get(x, y, z);
+      }
+    }
+  }
+  EXPECT_EQ(n, bricks.CountVoxels());
+}
@@ -1,3 +1,4 @@
+#include "random_cube.h"
 #include "sigen/builder/builder.h"
 #include "sigen/extractor/extractor.h"
 #include <boost/make_shared.hpp>
@@ -18,12 +19,20 @@ static BinaryCube vectorStringToBinaryCube(const std::vector<std::string> &vs) {
   BinaryCube cube(size_x + 2, size_y + 2, zdepth);
   for (int y = 0; y < size_y; ++y) {
     for (int x = 0; x < size_x; ++x) {
-      cube[x + 1][y + 1][1] = (vs[y][x] == '#');
+      cube.Set(x + 1, y + 1, 1, vs[y][x] == '#');
     }
   }
   return cube;
 }
 
+static int degree(const Builder &bld, const int i) {
+  int n = 0;
+  for (int k = 0; k < (int)bld.data_.edges_.size(); ++k) {
+    n += bld.data_.edges_[k].first == i || bld.data_.edges_[k].second == i;
+  }
+  return n;
+}
+
 // Fixture
 class BuilderTestAlpha : public ::testing::Test {
 protected:
@@ -35,7 +44,7 @@ protected:
     vs.push_back("###");
     BinaryCube cube = vectorStringToBinaryCube(vs);
     Extractor ext(cube);
-    std::vector<ClusterPtr> data = ext.Extract();
+    ClusterStore data = ext.Extract();
     bld = boost::make_shared<Builder>(data, 1.0, 1.0);
   }
 };
@@ -43,21 +52,21 @@ protected:
 TEST_F(BuilderTestAlpha, ConnectNeighbors) {
   bld->ConnectNeighbors();
   ASSERT_EQ(5, (int)bld->data_.size());
-  EXPECT_EQ(1, (int)bld->data_[0]->adjacent_.size());
-  EXPECT_EQ(2, (int)bld->data_[1]->adjacent_.size());
-  EXPECT_EQ(1, (int)bld->data_[2]->adjacent_.size());
-  EXPECT_EQ(1, (int)bld->data_[3]->adjacent_.size());
-  EXPECT_EQ(1, (int)bld->data_[4]->adjacent_.size());
+  EXPECT_EQ(1, degree(*bld, 0));
+  EXPECT_EQ(2, degree(*bld, 1));
+  EXPECT_EQ(1, degree(*bld, 2));
+  EXPECT_EQ(1, degree(*bld, 3));
+  EXPECT_EQ(1, degree(*bld, 4));
 }
 TEST_F(BuilderTestAlpha, ComputeGravityPoints) {
   bld->ConnectNeighbors();
   bld->ComputeGravityPoints();
-  EXPECT_DOUBLE_EQ(1.0, bld->data_[0]->gx_);
-  EXPECT_DOUBLE_EQ(3.0, bld->data_[0]->gy_);
-  EXPECT_DOUBLE_EQ(1.0, bld->data_[0]->gz_);
-  EXPECT_DOUBLE_EQ(2.0, bld->data_[4]->gx_);
-  EXPECT_DOUBLE_EQ(1.0, bld->data_[4]->gy_);
-  EXPECT_DOUBLE_EQ(1.0, bld->data_[4]->gz_);
+  EXPECT_DOUBLE_EQ(1.0, bld->data_.gx_[0]);
+  EXPECT_DOUBLE_EQ(3.0, bld->data_.gy_[0]);
+  EXPECT_DOUBLE_EQ(1.0, bld->data_.gz_[0]);
+  EXPECT_DOUBLE_EQ(2.0, bld->data_.gx_[4]);
+  EXPECT_DOUBLE_EQ(1.0, bld->data_.gy_[4]);
+  EXPECT_DOUBLE_EQ(1.0, bld->data_.gz_[4]);
 }
 TEST_F(BuilderTestAlpha, ConvertToNeuronNodes) {
   bld->ConnectNeighbors();
@@ -119,7 +128,7 @@ protected:
     vs.push_back(".#.");
     BinaryCube cube = vectorStringToBinaryCube(vs);
     Extractor ext(cube);
-    std::vector<ClusterPtr> data = ext.Extract();
+    ClusterStore data = ext.Extract();
     bld = boost::make_shared<Builder>(data, 1.0, 1.0);
   }
 };
@@ -173,3 +182,37 @@ TEST_F(BuilderTestBeta, ComputeIdsWithLoops) {
 TEST(Builder, DISABLED_ComputeNodeTypes) {
   ASSERT_TRUE(false);
 }
+TEST(Builder, EdgesFromExtractor) {
+  BinaryCube cube = randomCube(30, 20, 10, 1, 3);
+  Extractor ext(cube);
+  ClusterStore data = ext.Extract();
+  ASSERT_TRUE(data.has_edges_);
+  ASSERT_FALSE(data.edges_.empty());
+  Builder bld(data, 1.0, 1.0);
+  bld.ConnectNeighbors();
+  EXPECT_EQ(data.edges_, bld.data_.edges_);
+}
+TEST(Builder, SummaryFromExtractor) {
+  BinaryCube cube = randomCube(30, 20, 10, 2, 3);
+  Extractor ext(cube);
+  Builder bld(ext.Extract(), 0.5, 2.0);
+  bld.ComputeGravityPoints();
+  bld.ComputeRadius();
+
+  Extractor summarizing(cube);
+  summarizing.summarize_ = true;
+  summarizing.scale_xy_ = 0.5;
+  summarizing.scale_z_ = 2.0;
+  ClusterStore data = summarizing.Extract();
+  ASSERT_TRUE(data.has_summary_);
+  EXPECT_TRUE(data.points_.empty());
+  ASSERT_EQ(bld.data_.size(), data.size());
+  EXPECT_EQ(bld.data_.edges_, data.edges_);
+  EXPECT_EQ(bld.data_.gx_, data.gx_);
+  EXPECT_EQ(bld.data_.gy_, data.gy_);
+  EXPECT_EQ(bld.data_.gz_, data.gz_);
+  EXPECT_EQ(bld.data_.radius_, data.radius_);
+
+  Builder summarized(boost::move(data), 0.5, 2.0);
+  EXPECT_EQ(bld.Build().size(), summarized.Build().size());
+}
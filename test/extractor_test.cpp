@@ -1,5 +1,8 @@
+#include "random_cube.h"
+#include "sigen/common/parallel.h"
 #include "sigen/extractor/extractor.h"
 #include <boost/foreach.hpp>
+#include <cstdio>
 #include <gtest/gtest.h>
 #include <iostream>
 using namespace std;
@@ -15,12 +18,31 @@ static BinaryCube vectorStringToBinaryCube(const std::vector<std::string> &vs) {
   BinaryCube cube(size_x + 2, size_y + 2, zdepth);
   for (int y = 0; y < size_y; ++y) {
     for (int x = 0; x < size_x; ++x) {
-      cube[x + 1][y + 1][1] = (vs[y][x] == '#');
+      cube.Set(x + 1, y + 1, 1, vs[y][x] == '#');
     }
   }
   return cube;
 }
 
+// expects the same first `n` clusters, with their points in the same order
+static void expectSameClusters(const ClusterStore &expected, const ClusterStore &actual, const int n) {
+  ASSERT_LE(n, expected.size());
+  ASSERT_LE(n, actual.size());
+  for (int i = 0; i < n; ++i) {
+    ASSERT_EQ(expected.NumPoints(i), actual.NumPoints(i));
+    for (int j = 0; j < expected.NumPoints(i); ++j) {
+      EXPECT_FALSE(expected.Point(i, j) < actual.Point(i, j));
+      EXPECT_FALSE(actual.Point(i, j) < expected.Point(i, j));
+    }
+  }
+}
+
+// expects the same clusters, with their points in the same order
+static void expectSameClusters(const ClusterStore &expected, const ClusterStore &actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  expectSameClusters(expected, actual, expected.size());
+}
+
 TEST(Extractor, labeling) {
   std::vector<std::string> vs;
   vs.push_back("##.");
@@ -29,13 +51,13 @@ TEST(Extractor, labeling) {
   BinaryCube cube = vectorStringToBinaryCube(vs);
 
   Extractor ext(cube);
-  std::vector<ClusterPtr> ret = ext.Extract();
+  ClusterStore ret = ext.Extract();
   EXPECT_EQ(2, (int)ext.components_.size());
   EXPECT_EQ(3, (int)ext.components_[0].size());
   EXPECT_EQ(2, (int)ext.components_[1].size());
   EXPECT_EQ(5, (int)ret.size());
-  BOOST_FOREACH (ClusterPtr c, ret) {
-    EXPECT_EQ(1, (int)c->points_.size());
+  for (int i = 0; i < ret.size(); ++i) {
+    EXPECT_EQ(1, ret.NumPoints(i));
   }
 }
 TEST(Extractor, labeling2) {
@@ -45,7 +67,7 @@ TEST(Extractor, labeling2) {
   vs.push_back("##.");
   BinaryCube cube = vectorStringToBinaryCube(vs);
   Extractor ext(cube);
-  std::vector<ClusterPtr> ret = ext.Extract();
+  ClusterStore ret = ext.Extract();
   EXPECT_EQ(1, (int)ext.components_.size());
   EXPECT_EQ(5, (int)ext.components_[0].size());
   EXPECT_EQ(5, (int)ret.size());
@@ -57,7 +79,7 @@ TEST(Extractor, labeling_with_loops) {
   vs.push_back(".#.");
   BinaryCube cube = vectorStringToBinaryCube(vs);
   Extractor ext(cube);
-  std::vector<ClusterPtr> ret = ext.Extract();
+  ClusterStore ret = ext.Extract();
   EXPECT_EQ(1, (int)ext.components_.size());
   EXPECT_EQ(4, (int)ext.components_[0].size());
 }
@@ -67,10 +89,145 @@ TEST(Extractor, same_distance) {
   vs.push_back("##");
   BinaryCube cube = vectorStringToBinaryCube(vs);
   Extractor ext(cube);
-  std::vector<ClusterPtr> ret = ext.Extract();
+  ClusterStore ret = ext.Extract();
   EXPECT_EQ(1, (int)ext.components_.size());
   EXPECT_EQ(4, (int)ext.components_[0].size());
   EXPECT_EQ(2, (int)ret.size());
-  EXPECT_EQ(3, (int)ret[0]->points_.size());
-  EXPECT_EQ(1, (int)ret[1]->points_.size());
+  EXPECT_EQ(3, (int)ret.NumPoints(0));
+  EXPECT_EQ(1, (int)ret.NumPoints(1));
+}
+TEST(Extractor, voxel_order) {
+  // components list their voxels in (x, y, z) order, not in raster order
+  std::vector<std::string> vs;
+  vs.push_back("##");
+  vs.push_back("##");
+  BinaryCube cube = vectorStringToBinaryCube(vs);
+  Extractor ext(cube);
+  ext.Extract();
+  ASSERT_EQ(1, (int)ext.components_.size());
+  const std::vector<int> &group = ext.components_[0];
+  ASSERT_EQ(4, (int)group.size());
+  const int expected[4][2] = {{1, 1}, {1, 2}, {2, 1}, {2, 2}};
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(expected[i][0], ext.voxels_[group[i]].x_);
+    EXPECT_EQ(expected[i][1], ext.voxels_[group[i]].y_);
+  }
+}
+TEST(Extractor, double_sweep_seed) {
+  // the double sweep from (1, 1) ends at the blob, not at the tail
+  std::vector<std::string> vs;
+  vs.push_back("###.....");
+  vs.push_back("########");
+  vs.push_back("###.....");
+  BinaryCube cube = vectorStringToBinaryCube(vs);
+  Extractor ext(cube);
+  ClusterStore ret = ext.Extract();
+  ASSERT_EQ(8, (int)ret.size());
+  EXPECT_EQ(5, ret.NumPoints(0));
+  EXPECT_EQ(3, ret.NumPoints(1));
+  int seed = -1;
+  for (int i = 2; i < ret.size(); ++i) {
+    EXPECT_EQ(1, ret.NumPoints(i));
+    if (ret.Point(i, 0).x_ == 1 && ret.Point(i, 0).y_ == 3)
+      seed = i;
+  }
+  ASSERT_NE(-1, seed);
+}
+TEST(Extractor, move_cube) {
+  std::vector<std::string> vs;
+  vs.push_back("##.");
+  vs.push_back("...");
+  vs.push_back("###");
+  BinaryCube cube = vectorStringToBinaryCube(vs);
+  Extractor ext(boost::move(cube));
+  EXPECT_EQ(0, cube.x_);
+  ClusterStore ret = ext.Extract();
+  EXPECT_EQ(2, (int)ext.components_.size());
+  EXPECT_EQ(5, (int)ret.size());
+}
+TEST(Extractor, run_length_cube) {
+  BinaryCube cube = randomCube(40, 30, 20, 1, 5);
+  Extractor dense(cube);
+  ClusterStore expected = dense.Extract();
+  Extractor sparse((RunLengthCube(cube)));
+  ClusterStore actual = sparse.Extract();
+  ASSERT_EQ(dense.components_.size(), sparse.components_.size());
+  for (int i = 0; i < (int)dense.components_.size(); ++i) {
+    EXPECT_EQ(dense.components_[i].size(), sparse.components_[i].size());
+  }
+  expectSameClusters(expected, actual);
+}
+TEST(Extractor, bricked_cube) {
+  BinaryCube cube = randomCube(40, 30, 20, 2, 6);
+  Extractor dense(cube);
+  ClusterStore expected = dense.Extract();
+  Extractor bricked((BrickedCube(cube)));
+  ClusterStore actual = bricked.Extract();
+  ASSERT_EQ(dense.components_.size(), bricked.components_.size());
+  for (int i = 0; i < (int)dense.components_.size(); ++i) {
+    EXPECT_EQ(dense.components_[i].size(), bricked.components_[i].size());
+  }
+  expectSameClusters(expected, actual);
+}
+TEST(Extractor, mapped_cube) {
+  std::vector<std::string> vs;
+  vs.push_back("##.");
+  vs.push_back("...");
+  vs.push_back("###");
+  BinaryCube cube = vectorStringToBinaryCube(vs);
+  const std::string path = "extractor_test.cube";
+  {
+    BinaryCube mapped = BinaryCube::CreateMapped(path, cube.x_, cube.y_, cube.z_);
+    std::copy(cube.Row(0, 0), cube.Row(0, 0) + cube.WordsPerRow() * cube.y_ * cube.z_, mapped.Row(0, 0));
+  }
+  {
+    Extractor ext(BinaryCube::OpenMapped(path, true));
+    ClusterStore ret = ext.Extract();
+    EXPECT_EQ(2, (int)ext.components_.size());
+    EXPECT_EQ(5, (int)ret.size());
+  }
+  std::remove(path.c_str());
+}
+TEST(Extractor, threads) {
+  BinaryCube cube = randomCube(40, 30, 20, 3, 4);
+  const int num_threads = GetNumThreads();
+  SetNumThreads(1);
+  Extractor serial(cube);
+  ClusterStore expected = serial.Extract();
+  SetNumThreads(4);
+  Extractor parallel(cube);
+  ClusterStore actual = parallel.Extract();
+  SetNumThreads(num_threads);
+  expectSameClusters(expected, actual);
+}
+TEST(Extractor, frontier_bfs) {
+  BinaryCube cube = randomCube(40, 30, 20, 4, 3);
+  Extractor queue(cube);
+  queue.frontier_bfs_min_voxels_ = 0;
+  ClusterStore expected = queue.Extract();
+  Extractor bitwise(cube);
+  bitwise.frontier_bfs_min_voxels_ = 1;
+  ClusterStore actual = bitwise.Extract();
+  expectSameClusters(expected, actual);
+}
+TEST(Extractor, min_component_voxels) {
+  BinaryCube cube = randomCube(40, 30, 20, 5, 8);
+  Extractor all(cube);
+  ClusterStore expected = all.Extract();
+  Extractor large(cube);
+  large.min_component_voxels_ = 5;
+  ClusterStore actual = large.Extract();
+  // components are in descending order of size, so the large ones come first
+  int num_kept = 0;
+  for (int i = 0; i < (int)all.components_.size(); ++i) {
+    num_kept += all.components_[i].size() >= 5;
+  }
+  ASSERT_EQ(num_kept, (int)large.components_.size());
+  ASSERT_LT(num_kept, (int)all.components_.size());
+  ASSERT_GT(num_kept, 0);
+  for (int i = 0; i < num_kept; ++i) {
+    EXPECT_EQ(all.components_[i].size(), large.components_[i].size());
+  }
+  ASSERT_LT(actual.size(), expected.size());
+  expectSameClusters(expected, actual, actual.size());
 }
@@ -0,0 +1,43 @@
+#include "sigen/extractor/frontier_bfs.h"
+#include <gtest/gtest.h>
+#include <vector>
+using namespace sigen;
+
+static int count(const FrontierBfs &bfs) {
+  const BinaryCube &f = bfs.Frontier();
+  int n = 0;
+  for (int z = 0; z < f.z_; ++z)
+    for (int y = 0; y < f.y_; ++y)
+      for (int x = 0; x < f.x_; ++x)
+        n += f.Get(x, y, z);
+  return n;
+}
+
+TEST(FrontierBfs, levels) {
+  // an L of 100 voxels along x and 3 voxels along z, crossing word boundaries
+  std::vector<Voxel> voxels;
+  std::vector<int> group;
+  for (int x = 10; x < 110; ++x) {
+    voxels.push_back(Voxel(x, 5, 7));
+  }
+  for (int z = 8; z < 11; ++z) {
+    voxels.push_back(Voxel(109, 5, z));
+  }
+  for (int i = 0; i < (int)voxels.size(); ++i) {
+    group.push_back(i);
+  }
+  FrontierBfs bfs(voxels, group);
+  EXPECT_EQ(9, bfs.x0_);
+  EXPECT_EQ(4, bfs.y0_);
+  EXPECT_EQ(6, bfs.z0_);
+  bfs.Start(10, 5, 7);
+  EXPECT_EQ(1, count(bfs));
+  int levels = 1;
+  while (bfs.Next()) {
+    ++levels;
+    // (108, 5, 7) reaches both (109, 5, 7) and (109, 5, 8)
+    EXPECT_EQ(levels == 100 ? 2 : 1, count(bfs)) << levels;
+  }
+  EXPECT_EQ(102, levels);
+  EXPECT_EQ(0, count(bfs));
+}
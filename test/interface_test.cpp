@@ -0,0 +1,118 @@
+#include "sigen/interface.h"
+#include <algorithm>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <vector>
+using namespace sigen;
+
+static interface::Options defaultOptions() {
+  interface::Options options;
+  options.scale_xy = 1.0;
+  options.scale_z = 1.0;
+  options.enable_interpolation = false;
+  options.volume_threshold = 0;
+  options.distance_threshold = 0.0;
+  options.enable_smoothing = false;
+  options.smoothing_level = 0;
+  options.enable_clipping = false;
+  options.clipping_level = 0;
+  options.binarization_thresh = 128;
+  options.min_component_voxels = 0;
+  return options;
+}
+
+static std::vector<std::vector<double> > sortedNodes(
+    const std::vector<double> &x, const std::vector<double> &y,
+    const std::vector<double> &z, const std::vector<double> &r) {
+  std::vector<std::vector<double> > nodes;
+  for (int i = 0; i < (int)x.size(); ++i) {
+    std::vector<double> node;
+    node.push_back(x[i]);
+    node.push_back(y[i]);
+    node.push_back(z[i]);
+    node.push_back(r[i]);
+    nodes.push_back(node);
+  }
+  std::sort(nodes.begin(), nodes.end());
+  return nodes;
+}
+
+TEST(Interface, raw_buffer) {
+  const int X = 20, Y = 15, Z = 10, C = 2;
+  srand(1);
+  std::vector<unsigned char> data(X * Y * Z * C);
+  for (int i = 0; i < (int)data.size(); ++i) {
+    data[i] = rand() % 256;
+  }
+  const interface::Options options = defaultOptions();
+  // channel 1
+  BinaryCube cube(X, Y, Z);
+  for (int z = 0; z < Z; ++z) {
+    for (int y = 0; y < Y; ++y) {
+      for (int x = 0; x < X; ++x) {
+        cube.Set(x, y, z, data[x + X * y + X * Y * z + X * Y * Z] >= options.binarization_thresh);
+      }
+    }
+  }
+  std::vector<int> n0, type0, pn0, n1, type1, pn1;
+  std::vector<double> x0, y0, z0, r0, x1, y1, z1, r1;
+  interface::Extract(cube, n0, type0, x0, y0, z0, r0, pn0, options);
+  interface::Extract(&data[0], X, Y, Z, 1, X, X * Y, X * Y * Z, 1,
+                     n1, type1, x1, y1, z1, r1, pn1, options);
+  // the order of nodes depends on addresses, so compare them as sets
+  ASSERT_FALSE(n0.empty());
+  EXPECT_EQ(n0.size(), n1.size());
+  EXPECT_EQ(sortedNodes(x0, y0, z0, r0), sortedNodes(x1, y1, z1, r1));
+}
+
+TEST(Interface, raw_buffer_16bit_and_float) {
+  const int X = 70, Y = 12, Z = 8;
+  srand(2);
+  std::vector<unsigned char> data(X * Y * Z);
+  std::vector<unsigned short> data16(data.size());
+  std::vector<float> interleaved(data.size() * 2); // 2 channels, x-fastest pairs
+  for (int i = 0; i < (int)data.size(); ++i) {
+    data[i] = rand() % 256;
+    data16[i] = data[i] * 256 + rand() % 256;
+    interleaved[2 * i + 1] = data[i] + 0.5f;
+  }
+  interface::Options options = defaultOptions();
+  std::vector<int> n0, type0, pn0, n1, type1, pn1, n2, type2, pn2;
+  std::vector<double> x0, y0, z0, r0, x1, y1, z1, r1, x2, y2, z2, r2;
+  interface::Extract(&data[0], X, Y, Z, 1, X, X * Y, X * Y * Z, 0,
+                     n0, type0, x0, y0, z0, r0, pn0, options);
+  options.binarization_thresh = 128 * 256;
+  interface::Extract(&data16[0], X, Y, Z, 1, X, X * Y, X * Y * Z, 0,
+                     n1, type1, x1, y1, z1, r1, pn1, options);
+  options.binarization_thresh = 128.5;
+  interface::Extract(&interleaved[0], X, Y, Z, 2, 2 * X, 2 * X * Y, 1, 1,
+                     n2, type2, x2, y2, z2, r2, pn2, options);
+  ASSERT_FALSE(n0.empty());
+  EXPECT_EQ(sortedNodes(x0, y0, z0, r0), sortedNodes(x1, y1, z1, r1));
+  EXPECT_EQ(sortedNodes(x0, y0, z0, r0), sortedNodes(x2, y2, z2, r2));
+}
+
+TEST(Interface, float_thresh_not_a_float) {
+  // 0.7f < 0.7, so voxels of 0.7f are background on every path
+  const int X = 70, Y = 12, Z = 8;
+  const float values[] = {0.6f, 0.7f, 0.8f};
+  srand(3);
+  std::vector<float> data(X * Y * Z), interleaved(data.size() * 2);
+  for (int i = 0; i < (int)data.size(); ++i) {
+    data[i] = interleaved[2 * i] = values[rand() % 3];
+  }
+  interface::Options options = defaultOptions();
+  options.binarization_thresh = 0.7;
+  std::vector<int> n0, type0, pn0, n1, type1, pn1, n2, type2, pn2;
+  std::vector<double> x0, y0, z0, r0, x1, y1, z1, r1, x2, y2, z2, r2;
+  interface::Extract(&data[0], X, Y, Z, 1, X, X * Y, X * Y * Z, 0,
+                     n0, type0, x0, y0, z0, r0, pn0, options);
+  interface::Extract(&interleaved[0], X, Y, Z, 2, 2 * X, 2 * X * Y, 1, 0,
+                     n1, type1, x1, y1, z1, r1, pn1, options);
+  options.binarization_thresh = 0.75;
+  interface::Extract(&data[0], X, Y, Z, 1, X, X * Y, X * Y * Z, 0,
+                     n2, type2, x2, y2, z2, r2, pn2, options);
+  ASSERT_FALSE(n0.empty());
+  EXPECT_EQ(sortedNodes(x0, y0, z0, r0), sortedNodes(x1, y1, z1, r1));
+  EXPECT_EQ(sortedNodes(x0, y0, z0, r0), sortedNodes(x2, y2, z2, r2));
+}
@@ -0,0 +1,86 @@
+#include "random_cube.h"
+#include "sigen/extractor/labeling.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <vector>
+using namespace sigen;
+
+// brute force: flood fill in raster order
+static std::vector<int> bruteForce(const BinaryCube &cube) {
+  const int X = cube.x_, Y = cube.y_, Z = cube.z_;
+  std::vector<int> label(X * Y * Z, -1);
+  int next = 0;
+  for (int i = 0; i < (int)label.size(); ++i) {
+    if (!cube.Get(i % X, i / X % Y, i / X / Y) || label[i] != -1)
+      continue;
+    std::vector<int> stack(1, i);
+    label[i] = next;
+    while (!stack.empty()) {
+      const int cur = stack.back();
+      stack.pop_back();
+      const int x = cur % X, y = cur / X % Y, z = cur / X / Y;
+      for (int dz = -1; dz <= 1; ++dz)
+        for (int dy = -1; dy <= 1; ++dy)
+          for (int dx = -1; dx <= 1; ++dx) {
+            const int nx = x + dx, ny = y + dy, nz = z + dz;
+            if (nx < 0 || nx >= X || ny < 0 || ny >= Y || nz < 0 || nz >= Z)
+              continue;
+            const int n = (nz * Y + ny) * X + nx;
+            if (cube.Get(nx, ny, nz) && label[n] == -1) {
+              label[n] = next;
+              stack.push_back(n);
+            }
+          }
+    }
+    ++next;
+  }
+  return label;
+}
+
+TEST(Labeling, matches_brute_force) {
+  BinaryCube cube = randomCube(30, 20, 10, 1, 5);
+  const std::vector<int> expected = bruteForce(cube);
+  RunLengthCube runs(cube);
+  std::vector<int> labels;
+  const int n = LabelRuns(runs, labels);
+  ASSERT_EQ(runs.NumRuns(), (int)labels.size());
+  int max_label = -1;
+  for (int z = 0; z < cube.z_; ++z) {
+    for (int y = 0; y < cube.y_; ++y) {
+      for (int i = runs.RowBegin(y, z); i < runs.RowEnd(y, z); ++i) {
+        for (int x = runs.runs_[i].begin_; x < runs.runs_[i].end_; ++x) {
+          EXPECT_EQ(expected[(z * cube.y_ + y) * cube.x_ + x], labels[i]);
+        }
+        max_label = std::max(max_label, labels[i]);
+      }
+    }
+  }
+  EXPECT_EQ(max_label + 1, n);
+}
+
+TEST(Labeling, long_neurite) {
+  // a serpentine path of 1000 * 500 voxels would overflow a recursive fill
+  BinaryCube cube(1002, 1002, 3);
+  for (int y = 1; y <= 1000; ++y) {
+    if (y % 2 == 1) {
+      for (int x = 1; x <= 1000; ++x)
+        cube.Set(x, y, 1, true);
+    } else {
+      cube.Set(y % 4 == 2 ? 1000 : 1, y, 1, true);
+    }
+  }
+  std::vector<int> labels;
+  EXPECT_EQ(1, LabelRuns(RunLengthCube(cube), labels));
+}
+
+TEST(Labeling, slabs) {
+  BinaryCube cube = randomCube(25, 15, 17, 2, 4);
+  RunLengthCube runs(cube);
+  std::vector<int> expected;
+  const int n = LabelRuns(runs, expected, 1);
+  for (int slabs = 2; slabs <= 20; slabs += 3) {
+    std::vector<int> labels;
+    EXPECT_EQ(n, LabelRuns(runs, labels, slabs));
+    EXPECT_EQ(expected, labels) << slabs;
+  }
+}
@@ -0,0 +1,87 @@
+#include "sigen/common/neuron.h"
+#include <boost/weak_ptr.hpp>
+#include <gtest/gtest.h>
+#include <set>
+#include <vector>
+using namespace sigen;
+
+TEST(MakeNeuronNodes, block) {
+  boost::weak_ptr<NeuronNode> p;
+  {
+    std::vector<NeuronNodePtr> nodes = MakeNeuronNodes(3);
+    ASSERT_EQ(3, (int)nodes.size());
+    EXPECT_EQ(nodes[0].get() + 2, nodes[2].get());
+    // every node shares the count of the block
+    EXPECT_EQ(3, nodes[0].use_count());
+    // one node keeps the whole block
+    p = nodes[0];
+    nodes.resize(1);
+    EXPECT_EQ(1, nodes[0].use_count());
+    EXPECT_FALSE(p.expired());
+  }
+  EXPECT_TRUE(p.expired());
+  EXPECT_TRUE(MakeNeuronNodes(0).empty());
+}
+
+TEST(NeuronNode, adjacent_order) {
+  std::vector<NeuronNodePtr> nodes = MakeNeuronNodes(5);
+  for (int i = 0; i < 5; ++i) {
+    nodes[i]->id_ = i + 1;
+  }
+  nodes[0]->AddConnection(nodes[3]);
+  nodes[0]->AddConnection(nodes[1]);
+  nodes[0]->AddConnection(nodes[4]);
+  nodes[0]->AddConnection(nodes[2]);
+  // in ascending order of address, whatever the order of insertion
+  ASSERT_EQ(4, (int)nodes[0]->adjacent_.size());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(nodes[i + 1].get(), nodes[0]->adjacent_[i]);
+    EXPECT_TRUE(nodes[0]->HasConnection(nodes[i + 1]));
+  }
+  EXPECT_FALSE(nodes[0]->HasConnection(nodes[0]));
+  EXPECT_FALSE(nodes[1]->HasConnection(nodes[0]));
+  std::set<int> removed;
+  removed.insert(2);
+  removed.insert(4);
+  nodes[0]->RemoveConnections(removed);
+  ASSERT_EQ(2, (int)nodes[0]->adjacent_.size());
+  EXPECT_EQ(nodes[2].get(), nodes[0]->adjacent_[0]);
+  EXPECT_EQ(nodes[4].get(), nodes[0]->adjacent_[1]);
+}
+
+TEST(Neuron, Clone) {
+  // a path 1 - 2 - 3, rooted at 2
+  Neuron n;
+  n.storage_ = MakeNeuronNodes(3);
+  for (int i = 0; i < 3; ++i) {
+    n.storage_[i]->id_ = i + 1;
+    n.storage_[i]->setCoord(i, 2 * i, 3 * i);
+    n.storage_[i]->radius_ = 0.5 * i;
+  }
+  n.storage_[1]->AddConnection(n.storage_[2]);
+  n.storage_[1]->AddConnection(n.storage_[0]);
+  n.storage_[0]->AddConnection(n.storage_[1]);
+  n.storage_[2]->AddConnection(n.storage_[1]);
+  n.UpdateRoot(1);
+  Neuron c = n.Clone();
+  ASSERT_EQ(3, c.NumNodes());
+  // the clone is one new block, and refers to none of the original nodes
+  EXPECT_EQ(c.storage_[0].get() + 2, c.storage_[2].get());
+  EXPECT_EQ(c.storage_[1].get(), c.get_root());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NE(n.storage_[i].get(), c.storage_[i].get());
+    EXPECT_EQ(i + 1, c.storage_[i]->id_);
+    EXPECT_EQ(2 * i, c.storage_[i]->gy_);
+    EXPECT_EQ(0.5 * i, c.storage_[i]->radius_);
+  }
+  ASSERT_EQ(2, (int)c.storage_[1]->adjacent_.size());
+  EXPECT_EQ(c.storage_[0].get(), c.storage_[1]->adjacent_[0]);
+  EXPECT_EQ(c.storage_[2].get(), c.storage_[1]->adjacent_[1]);
+  ASSERT_EQ(1, (int)c.storage_[0]->adjacent_.size());
+  EXPECT_EQ(c.storage_[1].get(), c.storage_[0]->adjacent_[0]);
+  // the clone outlives the original
+  boost::weak_ptr<NeuronNode> original = n.storage_[0];
+  n.Clear();
+  EXPECT_TRUE(original.expired());
+  EXPECT_TRUE(c.storage_[1]->HasConnection(c.storage_[2]));
+}
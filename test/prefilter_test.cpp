@@ -0,0 +1,60 @@
+#include "random_cube.h"
+#include "sigen/extractor/prefilter.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+using namespace sigen;
+
+// brute force: clear the frame, then remove voxels without neighbors
+static BinaryCube bruteForce(const BinaryCube &cube) {
+  BinaryCube framed(cube.x_, cube.y_, cube.z_);
+  for (int z = 1; z < cube.z_ - 1; ++z)
+    for (int y = 1; y < cube.y_ - 1; ++y)
+      for (int x = 1; x < cube.x_ - 1; ++x)
+        framed.Set(x, y, z, cube.Get(x, y, z));
+  BinaryCube ret = framed;
+  for (int z = 0; z < cube.z_; ++z)
+    for (int y = 0; y < cube.y_; ++y)
+      for (int x = 0; x < cube.x_; ++x) {
+        if (!framed.Get(x, y, z))
+          continue;
+        bool any = false;
+        for (int dz = -1; dz <= 1; ++dz)
+          for (int dy = -1; dy <= 1; ++dy)
+            for (int dx = -1; dx <= 1; ++dx) {
+              const int nx = x + dx, ny = y + dy, nz = z + dz;
+              if ((dx != 0 || dy != 0 || dz != 0) && framed.Get(nx, ny, nz))
+                any = true;
+            }
+        ret.Set(x, y, z, any);
+      }
+  return ret;
+}
+
+static void expectSame(const BinaryCube &expected, const BinaryCube &actual) {
+  for (int z = 0; z < expected.z_; ++z)
+    for (int y = 0; y < expected.y_; ++y)
+      for (int x = 0; x < expected.x_; ++x)
+        EXPECT_EQ(expected.Get(x, y, z), actual.Get(x, y, z)) << x << " " << y << " " << z;
+}
+
+TEST(Prefilter, matches_brute_force) {
+  // rows of three words, so neighbors cross word boundaries
+  BinaryCube cube = randomCube(150, 9, 11, 1, 12);
+  const BinaryCube expected = bruteForce(cube);
+  Prefilter(cube);
+  expectSame(expected, cube);
+}
+
+TEST(Prefilter, slice_by_slice) {
+  // as during binarization: slice z - 1 is filtered after slice z is written
+  const BinaryCube input = randomCube(70, 8, 6, 2, 12);
+  const BinaryCube expected = bruteForce(input);
+  BinaryCube cube(input.x_, input.y_, input.z_);
+  for (int z = 0; z < input.z_; ++z) {
+    std::copy(input.Row(0, z), input.Row(0, z) + input.WordsPerRow() * input.y_, cube.Row(0, z));
+    if (z > 0)
+      PrefilterSlice(cube, z - 1);
+  }
+  PrefilterSlice(cube, cube.z_ - 1);
+  expectSame(expected, cube);
+}
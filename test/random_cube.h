@@ -0,0 +1,19 @@
+#pragma once
+#include "sigen/common/binary_cube.h"
+#include <cstdlib>
+namespace sigen {
+// A cube of x * y * z voxels, each set with probability 1 / `density`,
+// drawn from rand() seeded with `seed` in raster order.
+inline BinaryCube randomCube(const int x, const int y, const int z, const unsigned seed, const int density) {
+  srand(seed);
+  BinaryCube cube(x, y, z);
+  for (int k = 0; k < z; ++k) {
+    for (int j = 0; j < y; ++j) {
+      for (int i = 0; i < x; ++i) {
+        cube.Set(i, j, k, rand() % density == 0);
+      }
+    }
+  }
+  return cube;
+}
+} // namespace sigen
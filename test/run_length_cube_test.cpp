@@ -0,0 +1,60 @@
+#include "random_cube.h"
+#include "sigen/common/run_length_cube.h"
+#include <gtest/gtest.h>
+using namespace sigen;
+TEST(RunLengthCube, init) {
+  RunLengthCube cube(2, 3, 4);
+  EXPECT_EQ(2, cube.x_);
+  EXPECT_EQ(3, cube.y_);
+  EXPECT_EQ(4, cube.z_);
+  EXPECT_EQ(0, cube.NumRuns());
+  EXPECT_FALSE(cube.Get(1, 2, 3));
+}
+TEST(RunLengthCube, append) {
+  RunLengthCube cube(10, 3, 2);
+  cube.AppendRun(1, 0, 2, 5);
+  cube.AppendRun(1, 0, 7, 8);
+  cube.AppendRun(0, 1, 0, 10);
+  EXPECT_EQ(3, cube.NumRuns());
+  EXPECT_EQ(14, cube.CountVoxels());
+  EXPECT_EQ(0, cube.RowEnd(0, 0) - cube.RowBegin(0, 0));
+  EXPECT_EQ(2, cube.RowEnd(1, 0) - cube.RowBegin(1, 0));
+  EXPECT_EQ(1, cube.RowEnd(0, 1) - cube.RowBegin(0, 1));
+  EXPECT_EQ(0, cube.RowEnd(2, 1) - cube.RowBegin(2, 1));
+  EXPECT_FALSE(cube.Get(1, 1, 0));
+  EXPECT_TRUE(cube.Get(2, 1, 0));
+  EXPECT_TRUE(cube.Get(4, 1, 0));
+  EXPECT_FALSE(cube.Get(5, 1, 0));
+  EXPECT_TRUE(cube.Get(7, 1, 0));
+  EXPECT_TRUE(cube.Get(9, 0, 1));
+  EXPECT_TRUE(cube.AnyInRange(1, 0, 5, 7));
+  EXPECT_FALSE(cube.AnyInRange(1, 0, 5, 6));
+  EXPECT_FALSE(cube.AnyInRange(-1, 0, 0, 9));
+}
+TEST(RunLengthCube, from_binary_cube) {
+  BinaryCube cube = randomCube(150, 5, 4, 1, 3);
+  // runs crossing word boundaries and touching the end of rows
+  for (int x = 60; x < 150; ++x) {
+    cube.Set(x, 2, 1, true);
+  }
+  RunLengthCube runs(cube);
+  BinaryCube decoded = runs.ToBinaryCube();
+  for (int z = 0; z < cube.z_; ++z) {
+    for (int y = 0; y < cube.y_; ++y) {
+      for (int x = 0; x < cube.x_; ++x) {
+        EXPECT_EQ(cube.Get(x, y, z), runs.Get(x, y, z));
+        EXPECT_EQ(cube.Get(x, y, z), decoded.Get(x, y, z));
+      }
+    }
+  }
+  const sigen::Run &last = runs.runs_[runs.RowEnd(2, 1) - 1];
+  EXPECT_EQ(150, last.end_);
+}
+TEST(RunLengthCube, move) {
+  RunLengthCube cube(10, 3, 2);
+  cube.AppendRun(2, 1, 3, 4);
+  RunLengthCube moved(boost::move(cube));
+  EXPECT_TRUE(moved.Get(3, 2, 1));
+  EXPECT_EQ(0, cube.NumRuns());
+  EXPECT_EQ(0, cube.x_);
+}
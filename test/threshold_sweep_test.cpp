@@ -0,0 +1,93 @@
+#include "sigen/extractor/threshold_sweep.h"
+#include <algorithm>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <vector>
+using namespace sigen;
+
+// brute force: binarize, clear the frame and flood fill
+static SweepStats bruteForce(const std::vector<uint8_t> &data, int X, int Y, int Z, int thresh) {
+  std::vector<char> fg(data.size(), 0), visited(data.size(), 0);
+  for (int z = 1; z < Z - 1; ++z)
+    for (int y = 1; y < Y - 1; ++y)
+      for (int x = 1; x < X - 1; ++x)
+        fg[(z * Y + y) * X + x] = data[(z * Y + y) * X + x] > thresh;
+  SweepStats stats;
+  stats.thresh_ = thresh;
+  stats.num_components_ = 0;
+  stats.num_voxels_ = 0;
+  stats.largest_component_ = 0;
+  for (int i = 0; i < (int)data.size(); ++i) {
+    if (!fg[i] || visited[i])
+      continue;
+    std::vector<int> stack(1, i);
+    visited[i] = 1;
+    int size = 0;
+    while (!stack.empty()) {
+      const int cur = stack.back();
+      stack.pop_back();
+      ++size;
+      const int x = cur % X, y = cur / X % Y, z = cur / X / Y;
+      for (int dz = -1; dz <= 1; ++dz)
+        for (int dy = -1; dy <= 1; ++dy)
+          for (int dx = -1; dx <= 1; ++dx) {
+            const int nx = x + dx, ny = y + dy, nz = z + dz;
+            if (nx < 0 || nx >= X || ny < 0 || ny >= Y || nz < 0 || nz >= Z)
+              continue;
+            const int n = (nz * Y + ny) * X + nx;
+            if (fg[n] && !visited[n]) {
+              visited[n] = 1;
+              stack.push_back(n);
+            }
+          }
+    }
+    if (size >= 2) {
+      ++stats.num_components_;
+      stats.num_voxels_ += size;
+      stats.largest_component_ = std::max(stats.largest_component_, size);
+    }
+  }
+  return stats;
+}
+
+TEST(ThresholdSweep, matches_brute_force) {
+  const int X = 13, Y = 11, Z = 9;
+  std::srand(3);
+  std::vector<uint8_t> data(X * Y * Z);
+  for (int i = 0; i < (int)data.size(); ++i) {
+    data[i] = std::rand() % 256;
+  }
+  std::vector<double> thresholds;
+  thresholds.push_back(100);
+  thresholds.push_back(250);
+  thresholds.push_back(200);
+  thresholds.push_back(150);
+  thresholds.push_back(220);
+  ThresholdSweep sweep(X, Y, Z, 100, /* inclusive = */ false);
+  for (int z = 0; z < Z; ++z) {
+    for (int y = 0; y < Y; ++y) {
+      sweep.AddRow(y, z, &data[(z * Y + y) * X], 1);
+    }
+  }
+  std::vector<SweepStats> stats = sweep.Run(thresholds);
+  ASSERT_EQ(5, (int)stats.size());
+  for (int i = 0; i < (int)stats.size(); ++i) {
+    if (i > 0) {
+      EXPECT_GT(stats[i - 1].thresh_, stats[i].thresh_);
+    }
+    const SweepStats expected = bruteForce(data, X, Y, Z, (int)stats[i].thresh_);
+    EXPECT_EQ(expected.num_components_, stats[i].num_components_) << stats[i].thresh_;
+    EXPECT_EQ(expected.num_voxels_, stats[i].num_voxels_) << stats[i].thresh_;
+    EXPECT_EQ(expected.largest_component_, stats[i].largest_component_) << stats[i].thresh_;
+  }
+  EXPECT_GT(stats.back().num_components_, 0);
+
+  // the foreground at the last (lowest) threshold
+  RunLengthCube fg = sweep.Foreground();
+  for (int z = 0; z < Z; ++z)
+    for (int y = 0; y < Y; ++y)
+      for (int x = 0; x < X; ++x) {
+        const bool frame = x == 0 || x == X - 1 || y == 0 || y == Y - 1 || z == 0 || z == Z - 1;
+        EXPECT_EQ(!frame && data[(z * Y + y) * X + x] > 100, fg.Get(x, y, z));
+      }
+}
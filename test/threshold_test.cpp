@@ -0,0 +1,73 @@
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <sigen/common/threshold.h>
+#include <vector>
+using namespace sigen;
+
+template <class T>
+static void expectPacked(const std::vector<T> &src, const double thresh, const bool inclusive) {
+  const int n = src.size();
+  std::vector<uint64_t> dst((n + 63) / 64 + 1, ~(uint64_t)0);
+  if (inclusive)
+    PackGreaterEqual(&src[0], n, thresh, &dst[0]);
+  else
+    PackGreater(&src[0], n, thresh, &dst[0]);
+  for (int i = 0; i < (n + 63) / 64 * 64; ++i) {
+    const bool expected = i < n && (inclusive ? src[i] >= thresh : src[i] > thresh);
+    EXPECT_EQ(expected, (bool)((dst[i / 64] >> (i % 64)) & 1)) << i;
+  }
+  // words beyond the row are not touched
+  EXPECT_EQ(~(uint64_t)0, dst.back());
+}
+
+static const int lengths[] = {1, 15, 16, 63, 64, 65, 127, 128, 200};
+static const int num_lengths = sizeof(lengths) / sizeof(lengths[0]);
+
+TEST(Threshold, pack_8bit) {
+  std::srand(0);
+  const double threshs[] = {-1, 0, 1, 127, 127.5, 128, 200, 254, 255};
+  for (int i = 0; i < num_lengths; ++i) {
+    std::vector<uint8_t> src(lengths[i]);
+    for (int j = 0; j < (int)src.size(); ++j) {
+      src[j] = std::rand() % 256;
+    }
+    for (int j = 0; j < (int)(sizeof(threshs) / sizeof(threshs[0])); ++j) {
+      expectPacked(src, threshs[j], false);
+      expectPacked(src, threshs[j], true);
+    }
+  }
+}
+
+TEST(Threshold, pack_16bit) {
+  std::srand(0);
+  const double threshs[] = {-1, 0, 255, 256, 32767, 32768, 40000.5, 65534, 65535};
+  for (int i = 0; i < num_lengths; ++i) {
+    std::vector<uint16_t> src(lengths[i]);
+    for (int j = 0; j < (int)src.size(); ++j) {
+      src[j] = std::rand() % 65536;
+    }
+    src[0] = 32768;
+    for (int j = 0; j < (int)(sizeof(threshs) / sizeof(threshs[0])); ++j) {
+      expectPacked(src, threshs[j], false);
+      expectPacked(src, threshs[j], true);
+    }
+  }
+}
+
+TEST(Threshold, pack_float) {
+  std::srand(0);
+  // 0.7 and 0.1 are not floats: (float)0.7 < 0.7 and (float)0.1 > 0.1
+  const double threshs[] = {-1, 0, 0.1, 0.25, 0.5, 0.7, 1};
+  for (int i = 0; i < num_lengths; ++i) {
+    std::vector<float> src(lengths[i]);
+    for (int j = 0; j < (int)src.size(); ++j) {
+      src[j] = (std::rand() % 9) / 8.0f - 0.125f;
+    }
+    src[0] = 0.7f;
+    src[src.size() - 1] = 0.1f;
+    for (int j = 0; j < (int)(sizeof(threshs) / sizeof(threshs[0])); ++j) {
+      expectPacked(src, threshs[j], false);
+      expectPacked(src, threshs[j], true);
+    }
+  }
+}
@@ -0,0 +1,117 @@
+#include "random_cube.h"
+#include "sigen/builder/builder.h"
+#include "sigen/extractor/extractor.h"
+#include "sigen/extractor/tiled_extractor.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+using namespace sigen;
+
+static ClusterStore extractTiled(const BinaryCube &cube, const int depth, const bool summarize = true) {
+  TiledExtractor tiles(cube.x_, cube.y_, cube.z_, depth);
+  tiles.summarize_ = summarize;
+  for (int t = 0; t < tiles.NumTiles(); ++t) {
+    BinaryCube tile(cube.x_, cube.y_, tiles.ZEnd(t) - tiles.ZBegin(t));
+    for (int z = 0; z < tile.z_; ++z) {
+      for (int y = 0; y < tile.y_; ++y) {
+        for (int x = 0; x < tile.x_; ++x) {
+          tile.Set(x, y, z, cube.Get(x, y, z + tiles.ZBegin(t)));
+        }
+      }
+    }
+    tiles.ExtractTile(t, boost::move(tile));
+  }
+  return tiles.Stitch();
+}
+
+static int findRoot(std::vector<int> &parent, int i) {
+  while (parent[i] != i) {
+    i = parent[i] = parent[parent[i]];
+  }
+  return i;
+}
+
+// the voxels (as raster indexes) of each component of the cluster graph,
+// sorted, in ascending order
+static std::vector<std::vector<int> > componentVoxels(const ClusterStore &data, const BinaryCube &cube) {
+  std::vector<int> parent(data.size());
+  for (int i = 0; i < data.size(); ++i) {
+    parent[i] = i;
+  }
+  for (size_t k = 0; k < data.edges_.size(); ++k) {
+    parent[findRoot(parent, data.edges_[k].first)] = findRoot(parent, data.edges_[k].second);
+  }
+  std::map<int, std::vector<int> > components;
+  for (int i = 0; i < data.size(); ++i) {
+    std::vector<int> &voxels = components[findRoot(parent, i)];
+    for (int j = 0; j < data.NumPoints(i); ++j) {
+      const IPoint &p = data.Point(i, j);
+      voxels.push_back((p.z_ * cube.y_ + p.y_) * cube.x_ + p.x_);
+    }
+  }
+  std::vector<std::vector<int> > ret;
+  for (std::map<int, std::vector<int> >::iterator it = components.begin(); it != components.end(); ++it) {
+    std::sort(it->second.begin(), it->second.end());
+    ret.push_back(it->second);
+  }
+  std::sort(ret.begin(), ret.end());
+  return ret;
+}
+
+TEST(TiledExtractor, single_tile) {
+  BinaryCube cube = randomCube(14, 12, 8, 1, 4);
+  Extractor ext(cube);
+  ext.summarize_ = true;
+  ClusterStore expected = ext.Extract();
+  ClusterStore actual = extractTiled(cube, 8);
+  ASSERT_TRUE(actual.has_summary_);
+  ASSERT_TRUE(actual.has_edges_);
+  EXPECT_EQ(expected.gx_, actual.gx_);
+  EXPECT_EQ(expected.gy_, actual.gy_);
+  EXPECT_EQ(expected.gz_, actual.gz_);
+  EXPECT_EQ(expected.radius_, actual.radius_);
+  EXPECT_EQ(expected.edges_, actual.edges_);
+}
+
+TEST(TiledExtractor, tiles) {
+  const int x = 14, y = 12, z = 11;
+  BinaryCube cube = randomCube(x, y, z, 2, 4);
+  const ClusterStore whole = Extractor(cube).Extract();
+  const std::vector<std::vector<int> > expected = componentVoxels(whole, cube);
+  ASSERT_GT(expected.size(), 1u);
+  // some component crosses the face between slices 3 and 4
+  bool crossing = false;
+  for (size_t i = 0; i < expected.size(); ++i) {
+    crossing |= expected[i].front() < 4 * x * y && expected[i].back() >= 4 * x * y;
+  }
+  ASSERT_TRUE(crossing);
+  // tiles thinner than the halo, and tiles of 4 slices with a last tile of 3
+  const int depths[] = {1, 4};
+  for (int i = 0; i < 2; ++i) {
+    // the halo keeps the prefilter exact, and stitching joins components
+    ClusterStore tiled = extractTiled(cube, depths[i], false);
+    ASSERT_FALSE(tiled.has_summary_);
+    EXPECT_EQ(expected, componentVoxels(tiled, cube)) << depths[i];
+    Builder bld(boost::move(tiled), 1.0, 1.0);
+    EXPECT_EQ(expected.size(), bld.Build().size()) << depths[i];
+  }
+}
+
+TEST(TiledExtractor, neurite) {
+  // a line along z crosses every face
+  BinaryCube cube(10, 10, 20);
+  for (int z = 1; z < 19; ++z) {
+    cube.Set(5, 5, z, true);
+  }
+  ClusterStore data = extractTiled(cube, 3);
+  ASSERT_EQ(18, data.size());
+  std::vector<double> gz = data.gz_;
+  std::sort(gz.begin(), gz.end());
+  for (int i = 0; i < 18; ++i) {
+    EXPECT_EQ(i + 1, gz[i]);
+  }
+  EXPECT_EQ(17, (int)data.edges_.size());
+  Builder bld(boost::move(data), 1.0, 1.0);
+  EXPECT_EQ(1, (int)bld.Build().size());
+}
@@ -0,0 +1,46 @@
+#include "random_cube.h"
+#include "sigen/common/voxel_grid.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <vector>
+using namespace sigen;
+TEST(VoxelGrid, find) {
+  RunLengthCube cube(10, 3, 2);
+  cube.AppendRun(1, 0, 2, 5);
+  cube.AppendRun(1, 0, 7, 8);
+  cube.AppendRun(0, 1, 0, 10);
+  VoxelGrid grid(cube);
+  EXPECT_EQ(14, grid.NumVoxels());
+  EXPECT_EQ(-1, grid.Find(1, 1, 0));
+  EXPECT_EQ(0, grid.Find(2, 1, 0));
+  EXPECT_EQ(2, grid.Find(4, 1, 0));
+  EXPECT_EQ(-1, grid.Find(5, 1, 0));
+  EXPECT_EQ(3, grid.Find(7, 1, 0));
+  EXPECT_EQ(4, grid.Find(0, 0, 1));
+  EXPECT_EQ(13, grid.Find(9, 0, 1));
+  EXPECT_EQ(-1, grid.Find(-1, 0, 1));
+  EXPECT_EQ(-1, grid.Find(0, 3, 1));
+}
+TEST(VoxelGrid, neighbors) {
+  BinaryCube cube = randomCube(70, 6, 5, 1, 3);
+  VoxelGrid grid((RunLengthCube(cube)));
+  int out[26];
+  for (int z = 0; z < cube.z_; ++z) {
+    for (int y = 0; y < cube.y_; ++y) {
+      for (int x = 0; x < cube.x_; ++x) {
+        std::vector<int> expected;
+        for (int dx = -1; dx <= 1; ++dx) {
+          for (int dy = -1; dy <= 1; ++dy) {
+            for (int dz = -1; dz <= 1; ++dz) {
+              const int i = grid.Find(x + dx, y + dy, z + dz);
+              if ((dx != 0 || dy != 0 || dz != 0) && i != -1)
+                expected.push_back(i);
+            }
+          }
+        }
+        const int n = grid.Neighbors(x, y, z, out);
+        EXPECT_EQ(expected, std::vector<int>(out, out + n));
+      }
+    }
+  }
+}
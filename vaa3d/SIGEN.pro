@@ -12,6 +12,16 @@ MOC_DIR = build
 
 QMAKE_CXXFLAGS += -Wall -Wextra -Wshadow -Wno-c++11-extensions
 
+# Parallel loops are optional (see src/sigen/common/parallel.h).
+# Build with `qmake CONFIG+=openmp` if the toolchain has OpenMP.
+# Without it, the `#pragma omp` lines are ignored on purpose.
+openmp {
+  QMAKE_CXXFLAGS += -fopenmp
+  QMAKE_LFLAGS += -fopenmp
+} else {
+  QMAKE_CXXFLAGS += -Wno-unknown-pragmas
+}
+
 INCLUDEPATH += $$VAA3DPATH/v3d_main/basic_c_fun
 INCLUDEPATH += $$VAA3DPATH/v3d_main/common_lib/include
 SOURCES	+= $$VAA3DPATH/v3d_main/basic_c_fun/v3d_message.cpp
@@ -24,8 +34,18 @@ INCLUDEPATH += ../src
 INCLUDEPATH += ../third_party
 SOURCES += ../src/sigen/interface.cpp
 SOURCES += ../src/sigen/builder/builder.cpp
+SOURCES += ../src/sigen/common/binary_cube.cpp
+SOURCES += ../src/sigen/common/bricked_cube.cpp
 SOURCES += ../src/sigen/common/disjoint_set.cpp
 SOURCES += ../src/sigen/common/neuron.cpp
+SOURCES += ../src/sigen/common/run_length_cube.cpp
+SOURCES += ../src/sigen/common/threshold.cpp
+SOURCES += ../src/sigen/common/voxel_grid.cpp
 SOURCES += ../src/sigen/extractor/extractor.cpp
+SOURCES += ../src/sigen/extractor/frontier_bfs.cpp
+SOURCES += ../src/sigen/extractor/labeling.cpp
+SOURCES += ../src/sigen/extractor/prefilter.cpp
+SOURCES += ../src/sigen/extractor/threshold_sweep.cpp
+SOURCES += ../src/sigen/extractor/tiled_extractor.cpp
 SOURCES += ../src/sigen/toolbox/toolbox.cpp
 SOURCES += ../third_party/kdtree/kdtree.c
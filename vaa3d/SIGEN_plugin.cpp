@@ -9,7 +9,6 @@
 
 #include "SIGEN_plugin.h"
 
-#include "sigen/common/binary_cube.h"
 #include "sigen/interface.h"
 Q_EXPORT_PLUGIN2(SIGEN, SigenPlugin);
 
@@ -95,34 +94,6 @@ bool SigenPlugin::dofunc(
   return true;
 }
 
-static sigen::BinaryCube convertToBinaryCube(
-    const unsigned char *p,
-    const int unit_byte,
-    const int xdim,
-    const int ydim,
-    const int zdim,
-    const int /* channel_dim */,
-    const int channel,
-    const int bin_thresh) {
-  const int stride_x = unit_byte;
-  const int stride_y = unit_byte * xdim;
-  const int stride_z = unit_byte * xdim * ydim;
-  const int stride_c = unit_byte * xdim * ydim * zdim;
-  sigen::BinaryCube cube(xdim, ydim, zdim);
-  for (int x = 0; x < xdim; ++x) {
-    for (int y = 0; y < ydim; ++y) {
-      for (int z = 0; z < zdim; ++z) {
-        if (p[stride_x * x + stride_y * y + stride_z * z + stride_c * channel] >= bin_thresh) {
-          cube[x][y][z] = true;
-        } else {
-          cube[x][y][z] = false;
-        }
-      }
-    }
-  }
-  return cube;
-}
-
 static QLineEdit *addIntEdit(const QString &default_value, QWidget *parent) {
   QIntValidator *v = new QIntValidator(parent);
   v->setBottom(0);
@@ -183,9 +154,12 @@ static bool getConfig(QWidget *parent, sigen::interface::Options *options) {
 
   QObject::connect(clipping_checkbox, SIGNAL(toggled(bool)), cl_lineEdit, SLOT(setEnabled(bool)));
 
-  QLineEdit *th_lineEdit = addIntEdit("128", parent);
+  QLineEdit *th_lineEdit = addDoubleEdit("128", parent);
   fLayout->addRow(QObject::tr("Binarization Threshold"), th_lineEdit);
 
+  QLineEdit *mv_lineEdit = addIntEdit("0", parent);
+  fLayout->addRow(QObject::tr("Min Component Voxels"), mv_lineEdit);
+
   QDialogButtonBox *buttonBox = new QDialogButtonBox(
       QDialogButtonBox::Ok | QDialogButtonBox::Cancel,
       Qt::Horizontal,
@@ -231,7 +205,8 @@ static bool getConfig(QWidget *parent, sigen::interface::Options *options) {
 
     options->enable_clipping = clipping_checkbox->checkState() == Qt::Checked;
     options->clipping_level = cl_lineEdit->text().toInt();
-    options->binarization_thresh = th_lineEdit->text().toInt();
+    options->binarization_thresh = th_lineEdit->text().toDouble();
+    options->min_component_voxels = mv_lineEdit->text().toInt();
   }
 
   return retval;
@@ -245,6 +220,7 @@ void reconstruction_func(
   unsigned char *data1d = NULL;
   V3DLONG N, M, P, sc, c;
   V3DLONG in_sz[4];
+  int datatype = 0; // V3D_UINT8, V3D_UINT16 or V3D_FLOAT32
   if (via_gui) {
     v3dhandle curwin = callback.currentImageWindow();
     if (!curwin) {
@@ -257,6 +233,7 @@ void reconstruction_func(
       return;
     }
     data1d = p4DImage->getRawData();
+    datatype = p4DImage->getDatatype();
     N = p4DImage->getXDim();
     M = p4DImage->getYDim();
     P = p4DImage->getZDim();
@@ -277,7 +254,6 @@ void reconstruction_func(
     in_sz[3] = sc;
     PARA.inimg_file = p4DImage->getFileName();
   } else {
-    int datatype = 0;
     if (!simple_loadimage_wrapper(callback, PARA.inimg_file.toStdString().c_str(), data1d, in_sz, datatype)) {
       fprintf(stderr, "Error happens in reading the subject file [%s]. Exit. \n", PARA.inimg_file.toStdString().c_str());
       return;
@@ -292,6 +268,13 @@ void reconstruction_func(
     sc = in_sz[3];
     c = PARA.channel;
   }
+  if (datatype != V3D_UINT8 && datatype != V3D_UINT16 && datatype != V3D_FLOAT32) {
+    v3d_msg(QString("Unsupported data type [%1].").arg(datatype), via_gui);
+    if (!via_gui && data1d) {
+      delete[] data1d;
+    }
+    return;
+  }
   //main neuron reconstruction code
   //// THIS IS WHERE THE DEVELOPERS SHOULD ADD THEIR OWN NEURON TRACING CODE
 
@@ -306,13 +289,36 @@ void reconstruction_func(
   // v3d_msg(QString("VT = %1\nDT = %2\nSM = %3\nCL = %4").arg(options.volume_threshold).arg(options.distance_threshold).arg(options.smoothing_level).arg(options.clipping_level), via_gui);
   // return;
 
-  sigen::BinaryCube cube = convertToBinaryCube(data1d, /* unit_byte = */ 1, N, M, P, sc, c - 1, options.binarization_thresh);
+  // binarize on the fly, directly from the Vaa3D buffer
   std::vector<int> out_n, out_type, out_pn;
   std::vector<double> out_x, out_y, out_z, out_r;
-  sigen::interface::Extract(
-      cube, out_n, out_type,
-      out_x, out_y, out_z,
-      out_r, out_pn, options);
+  // 16-bit and float voxels are thresholded natively, without an 8-bit copy
+  switch (datatype) {
+  case V3D_UINT8:
+    sigen::interface::Extract(
+        data1d, N, M, P,
+        /* stride_x = */ 1, /* stride_y = */ N, /* stride_z = */ N * M, /* stride_c = */ N * M * P,
+        c - 1, out_n, out_type,
+        out_x, out_y, out_z,
+        out_r, out_pn, options);
+    break;
+  case V3D_UINT16:
+    sigen::interface::Extract(
+        (const unsigned short *)data1d, N, M, P,
+        /* stride_x = */ 1, /* stride_y = */ N, /* stride_z = */ N * M, /* stride_c = */ N * M * P,
+        c - 1, out_n, out_type,
+        out_x, out_y, out_z,
+        out_r, out_pn, options);
+    break;
+  case V3D_FLOAT32:
+    sigen::interface::Extract(
+        (const float *)data1d, N, M, P,
+        /* stride_x = */ 1, /* stride_y = */ N, /* stride_z = */ N * M, /* stride_c = */ N * M * P,
+        c - 1, out_n, out_type,
+        out_x, out_y, out_z,
+        out_r, out_pn, options);
+    break;
+  }
 
   // construct NeuronTree
   NeuronTree nt;